@@ -0,0 +1,140 @@
+/**
+ * @file    box_smx_dispatch.h
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Dispatcher box implementation for the runtime system library of Streamix
+ */
+
+#include "smxtypes.h"
+
+#ifndef BOX_SMX_DISPATCH_H
+#define BOX_SMX_DISPATCH_H
+
+#define SMX_INDEGREE_smx_dispatch 0
+#define SMX_OUTDEGREE_smx_dispatch 0
+
+/**
+ * The skew factor (largest partition count over mean partition count) above
+ * which a warning is logged when a partitioning dispatcher terminates.
+ */
+#define SMX_DISPATCH_SKEW_WARN 1.5
+
+typedef struct net_smx_dispatch_state_s net_smx_dispatch_state_t;
+typedef struct smx_dispatch_s smx_dispatch_t;
+
+/**
+ * The attributes of a dispatcher net.
+ */
+struct smx_dispatch_s
+{
+    bool            is_partitioned; /**< route by partition key? */
+    int             count;          /**< the number of partitions */
+    unsigned long*  msg_counts;     /**< the number of messages per partition */
+    unsigned long   unkeyed_count;  /**< messages without partition key */
+};
+
+/**
+ * The persistent state of a dispatcher net.
+ */
+struct net_smx_dispatch_state_s
+{
+    int next_idx;   /**< the index of the output port to write to next */
+};
+
+/**
+ * Compute the partition skew of a dispatcher. The skew is the largest number
+ * of messages routed to one partition divided by the mean number of messages
+ * per partition. A perfectly balanced dispatcher has a skew of 1.
+ *
+ * @param net
+ *  A pointer to the dispatcher net handler.
+ * @return
+ *  The skew factor or 0 if no message was dispatched yet.
+ */
+double smx_dispatch_get_skew( smx_net_t* net );
+
+/**
+ * Log the number of messages routed to each partition and the resulting skew
+ * (see smx_dispatch_get_skew()). This can be called at any time.
+ *
+ * @param net
+ *  A pointer to the dispatcher net handler.
+ */
+void smx_dispatch_log_partitions( smx_net_t* net );
+
+/**
+ * @brief Destroy the dispatcher attribute structure
+ *
+ * @param net   a pointer to the net handler
+ */
+void smx_net_destroy_dispatch( smx_net_t* net );
+
+/**
+ * @brief Initialize the dispatcher attribute structure. This must be called
+ * after the net signature was initialised with smx_net_init().
+ *
+ * @param net               a pointer to the net handler
+ * @param is_partitioned    if true, messages are routed by their partition key
+ *                          (see smx_msg_set_partition_key()), otherwise in a
+ *                          round-robin manner.
+ */
+void smx_net_init_dispatch( smx_net_t* net, bool is_partitioned );
+
+/**
+ * @brief the box implementation of a dispatcher
+ *
+ * A dispatcher reads a message from its single input port and writes it to
+ * one of its output ports. By default, the output ports are served in a
+ * round-robin manner. Together with a merger (see smx_merge()) this allows to
+ * distribute messages among the replicas of a net while preserving the
+ * message order.
+ *
+ * A partitioning dispatcher writes a message to the output port
+ * `hash(key) % N` where `key` is the partition key of the message and `N` the
+ * number of output ports. This guarantees that all messages with the same key
+ * are processed by the same replica. Messages without partition key are
+ * dispatched in a round-robin manner.
+ *
+ * @param h     a pointer to the net handler
+ * @param state a pointer to the persistent state structure
+ * @return      returns the state of the box
+ */
+int smx_dispatch( void* h, void* state );
+
+/**
+ * Initialises the dispatcher. The state is allocated with the index of the
+ * next output port.
+ *
+ * @param h     pointer to the net handler
+ * @param state pointer to the state variable
+ * @return      0 on success, -1 on failure
+ */
+int smx_dispatch_init( void* h, void** state );
+
+/**
+ * Cleanup the dispatcher by freeing the state variable. The partition
+ * statistics are logged (see smx_dispatch_log_partitions()).
+ *
+ * @param h     pointer to the net handler
+ * @param state pointer to the state variable
+ */
+void smx_dispatch_cleanup( void* h, void* state );
+
+/**
+ * This function is predefined and must not be changed. It will be passed to the
+ * net thread upon creation and will be executed as soon as the thread is
+ * started. This function calls a macro which is define in the RTS and handles
+ * the initialisation, the main loop of the net and the cleanup.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ * @return
+ *  This function always returns NULL.
+ */
+void* start_routine_smx_dispatch( void* h );
+
+#endif
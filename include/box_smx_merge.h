@@ -0,0 +1,77 @@
+/**
+ * @file    box_smx_merge.h
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Merger box implementation for the runtime system library of Streamix
+ */
+
+#include "smxtypes.h"
+
+#ifndef BOX_SMX_MERGE_H
+#define BOX_SMX_MERGE_H
+
+#define SMX_INDEGREE_smx_merge 0
+#define SMX_OUTDEGREE_smx_merge 0
+
+typedef struct net_smx_merge_state_s net_smx_merge_state_t;
+
+/**
+ * The persistent state of a merger net.
+ */
+struct net_smx_merge_state_s
+{
+    int next_idx;   /**< the index of the input port to read from next */
+};
+
+/**
+ * @brief the box implementation of an order-preserving merger
+ *
+ * A merger reads a message from one of its input ports and writes it to its
+ * single output port. The input ports are served in a round-robin manner and
+ * a read blocks until the expected input port provides a message. This
+ * restores the order of messages that were distributed by a dispatcher (see
+ * smx_dispatch()) as long as every replica produces exactly one output message
+ * per input message.
+ *
+ * @param h     a pointer to the net handler
+ * @param state a pointer to the persistent state structure
+ * @return      returns the state of the box
+ */
+int smx_merge( void* h, void* state );
+
+/**
+ * Initialises the merger. The state is allocated with the index of the next
+ * input port.
+ *
+ * @param h     pointer to the net handler
+ * @param state pointer to the state variable
+ * @return      0 on success, -1 on failure
+ */
+int smx_merge_init( void* h, void** state );
+
+/**
+ * Cleanup the merger by freeing the state variable.
+ *
+ * @param h     pointer to the net handler
+ * @param state pointer to the state variable
+ */
+void smx_merge_cleanup( void* h, void* state );
+
+/**
+ * This function is predefined and must not be changed. It will be passed to the
+ * net thread upon creation and will be executed as soon as the thread is
+ * started. This function calls a macro which is define in the RTS and handles
+ * the initialisation, the main loop of the net and the cleanup.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ * @return
+ *  This function always returns NULL.
+ */
+void* start_routine_smx_merge( void* h );
+
+#endif
@@ -18,7 +18,8 @@
 #define SMX_OUTDEGREE_smx_rn 0
 
 /**
- * Connect a routing node to a channel
+ * Connect a routing node to a channel. A rendezvous channel is converted to a
+ * FIFO of length 1 because a routing node needs to peek at its inputs.
  *
  * @param ch    the target channel
  * @param rn    a pointer to the net handler
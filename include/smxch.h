@@ -14,6 +14,35 @@
 #ifndef SMXCH_H
 #define SMXCH_H
 
+/** The number of channels logged per list by the blocking report at exit */
+#define SMX_CHANNEL_BLOCK_REPORT_COUNT 5
+
+/** The minimal interval between two anomaly logs of a channel end in ms */
+#define SMX_CHANNEL_ANOMALY_LOG_INTERVAL_MS 1000
+
+/**
+ * @def SMX_LOG_CH_ANOMALY()
+ *
+ * Log a channel anomaly with SMX_LOG_CH() if the level is enabled and the log
+ * is not suppressed by the rate limit of the channel end (see
+ * smx_channel_end_is_anomaly_logged()).
+ *
+ * @param ch
+ *  The pointer to the channel.
+ * @param end
+ *  The pointer to the channel end of the net logging the anomaly.
+ * @param level
+ *  The log level, e.g. `info` or `warn`.
+ * @param format
+ *  The printf format string.
+ * @param ...
+ *  The arguments of the format string.
+ */
+#define SMX_LOG_CH_ANOMALY( ch, end, level, format, ... ) do {\
+    if( smx_channel_end_is_anomaly_logged( ch, end, SMX_LOG_LEVEL_ ## level ) )\
+        SMX_LOG_CH( ch, level, format, ##__VA_ARGS__ );\
+    } while( 0 )
+
 /**
  * @def SMX_CHANNEL_SET_BACKUP()
  *
@@ -171,6 +200,71 @@
 #define SMX_SET_WRITE_TIMEOUT( h, box_name, ch_name, sec, nsec )\
     smx_set_write_timeout( SMX_SIG_PORT( h, box_name, ch_name, out ), sec, nsec )
 
+/**
+ * @def SMX_SET_WAKE_MODERATION()
+ *
+ * Moderate the wakeups of the consumer of an input channel. Refer to
+ * smx_channel_set_wake_moderation() for more information.
+ *
+ * @param h
+ *  The pointer to the net handler.
+ * @param box_name
+ *  The name of the box. Note that this is not a string but the literal name of
+ *  the box (without quotation marks).
+ * @param ch_name
+ *  The name of the input port. Note that this is not a string but the literal
+ *  name of the port (without quotation marks).
+ * @param threshold
+ *  The number of queued messages which wake the consumer
+ * @param delay_us
+ *  The maximal number of microseconds a queued message waits for the wakeup
+ * @return
+ *  0 on success, -1 otherwise
+ */
+#define SMX_SET_WAKE_MODERATION( h, box_name, ch_name, threshold, delay_us )\
+    smx_channel_set_wake_moderation( SMX_SIG_PORT( h, box_name, ch_name, in ),\
+            threshold, delay_us )
+
+/**
+ * @def SMX_SET_LATENCY_HIST()
+ *
+ * Record the end-to-end latency of the messages read from an input channel.
+ * Refer to smx_channel_set_latency_hist() for more information.
+ *
+ * @param h
+ *  The pointer to the net handler.
+ * @param box_name
+ *  The name of the box. Note that this is not a string but the literal name of
+ *  the box (without quotation marks).
+ * @param ch_name
+ *  The name of the input port. Note that this is not a string but the literal
+ *  name of the port (without quotation marks).
+ * @return
+ *  0 on success, -1 otherwise
+ */
+#define SMX_SET_LATENCY_HIST( h, box_name, ch_name )\
+    smx_channel_set_latency_hist( SMX_SIG_PORT( h, box_name, ch_name, in ) )
+
+/**
+ * @def SMX_SET_QUEUE_HIST()
+ *
+ * Record the queueing delay of the messages read from an input channel.
+ * Refer to smx_channel_set_queue_hist() for more information.
+ *
+ * @param h
+ *  The pointer to the net handler.
+ * @param box_name
+ *  The name of the box. Note that this is not a string but the literal name of
+ *  the box (without quotation marks).
+ * @param ch_name
+ *  The name of the input port. Note that this is not a string but the literal
+ *  name of the port (without quotation marks).
+ * @return
+ *  0 on success, -1 otherwise
+ */
+#define SMX_SET_QUEUE_HIST( h, box_name, ch_name )\
+    smx_channel_set_queue_hist( SMX_SIG_PORT( h, box_name, ch_name, in ) )
+
 
 #endif /* SMX_TESTING */
 
@@ -271,7 +365,8 @@ void smx_channel_change_write_state( smx_channel_t* ch,
  *
  * @param ch_cnt    pointer to the channel counter (is increased by one after
  *                  channel creation)
- * @param len       length of a FIFO
+ * @param len       length of a FIFO. A FIFO of length 0 is created as
+ *                  rendezvous channel (#SMX_RENDEZVOUS).
  * @param type      type of the buffer
  * @param id        unique identifier of the channel
  * @param name      name of the channel
@@ -303,6 +398,121 @@ void smx_channel_destroy( smx_channel_t* ch );
  */
 void smx_channel_destroy_end( smx_channel_end_t* end );
 
+/**
+ * Account a blocking episode of a channel end. The time from `start` until now
+ * is added to the blocked time of the end. This must only be called by the
+ * net connected to the end.
+ *
+ * @param end
+ *  A pointer to the channel end.
+ * @param start
+ *  The CLOCK_MONOTONIC time the end started to block.
+ */
+void smx_channel_end_add_block_time( smx_channel_end_t* end,
+        struct timespec* start );
+
+/**
+ * Rate-limit the logs of channel anomalies like overwritten or duplicated
+ * messages and missed deadlines. At most one anomaly per
+ * #SMX_CHANNEL_ANOMALY_LOG_INTERVAL_MS is logged per channel end, all others
+ * are counted. When an anomaly is logged after others were suppressed, the
+ * number of suppressed logs is reported first at the level of the anomaly.
+ * Anomalies with a disabled log level are neither logged nor counted. This
+ * must only be called by the net connected to the end.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param end
+ *  A pointer to the channel end of the net logging the anomaly.
+ * @param level
+ *  The zlog level of the anomaly log.
+ * @return
+ *  True if the anomaly may be logged, false if the level is disabled or the
+ *  log is suppressed.
+ */
+bool smx_channel_end_is_anomaly_logged( smx_channel_t* ch,
+        smx_channel_end_t* end, int level );
+
+/**
+ * Log the number of suppressed anomaly logs of a channel end.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param end
+ *  A pointer to the channel end.
+ * @param level
+ *  The zlog level of the suppressed anomaly logs.
+ * @param interval_ms
+ *  The time since the last logged anomaly in milliseconds.
+ */
+void smx_channel_end_log_suppressed( smx_channel_t* ch,
+        smx_channel_end_t* end, int level, uint64_t interval_ms );
+
+/**
+ * Get a percentile of the end-to-end latency of the messages read from a
+ * channel. This can be called at any time by any thread.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param percentile
+ *  The percentile in the range [0, 100], e.g. 99.9.
+ * @return
+ *  The latency in nanoseconds or 0 if the latency is not recorded.
+ */
+uint64_t smx_channel_get_latency( smx_channel_t* ch, double percentile );
+
+/**
+ * Get a percentile of the time messages spent in the FIFO of a channel. This
+ * can be called at any time by any thread.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param percentile
+ *  The percentile in the range [0, 100], e.g. 99.9.
+ * @return
+ *  The queueing delay in nanoseconds or 0 if the delay is not recorded.
+ */
+uint64_t smx_channel_get_queue_delay( smx_channel_t* ch, double percentile );
+
+/**
+ * Re-initialise the channel mutex. A channel is created with a priority
+ * inheritance mutex because the connecting nets are not known at creation.
+ * This must only be called while no net is accessing the channel.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param is_prio_inherit
+ *  If true, a mutex with priority inheritance is used, otherwise an adaptive
+ *  mutex (see smx_mutex_init()).
+ */
+void smx_channel_init_mutex( smx_channel_t* ch, bool is_prio_inherit );
+
+/**
+ * Check whether a TT net (a net with a priority > 0) is connected to either
+ * end of a channel.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @return
+ *  true if a TT net is connected, false otherwise.
+ */
+bool smx_channel_is_rt( smx_channel_t* ch );
+
+/**
+ * Log the channels with the largest blocked time, separately for blocked
+ * reads (starvation of the consumer) and blocked writes (backpressure on the
+ * producer). This can be called at any time while the channels exist.
+ *
+ * @param chs
+ *  The list of channels.
+ * @param ch_cnt
+ *  The number of channels in the list.
+ * @param count
+ *  The maximal number of channels to log per list.
+ */
+void smx_channel_log_block_report( smx_channel_t** chs, int ch_cnt,
+        int count );
+
 /**
  * @brief Read the data from an input port
  *
@@ -377,6 +587,67 @@ bool smx_channel_set_content_filter( smx_channel_t* ch,
  */
 bool smx_channel_set_filter( smx_net_t* h, smx_channel_t* ch, int count, ... );
 
+/**
+ * Record the end-to-end latency of all messages read from a channel in a
+ * histogram. The latency is the time between the origin time of a message
+ * (see smx_msg_inherit_origin()) and the successful read. The histogram is
+ * logged when the channel is destroyed. Calling this function on a channel
+ * that already records the latency has no effect. The histogram pointer is
+ * not protected, so this must be called before the net threads are started.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @return
+ *  0 on success, -1 otherwise
+ */
+int smx_channel_set_latency_hist( smx_channel_t* ch );
+
+/**
+ * Record the time messages spend in the FIFO of a channel in a histogram.
+ * Each FIFO slot stores the time a message was enqueued and the queueing
+ * delay is recorded when the message is read. Messages duplicated from the
+ * backup of a decoupled channel are not recorded. The histogram is logged
+ * when the channel is destroyed. Calling this function on a channel that
+ * already records the queueing delay has no effect. The histogram pointer is
+ * not protected, so this must be called before the net threads are started.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @return
+ *  0 on success, -1 otherwise
+ */
+int smx_channel_set_queue_hist( smx_channel_t* ch );
+
+/**
+ * Moderate the wakeups of a blocked consumer, similar to the interrupt
+ * moderation of a network card. Instead of waking the consumer on every
+ * message, the consumer is woken once `threshold` messages are queued or once
+ * the first queued message waited for `delay_us` microseconds, whichever
+ * happens first. A full FIFO always wakes the consumer. This allows the
+ * consumer to process larger batches per wakeup at the cost of latency.
+ *
+ * If the consumer has a read timeout (see smx_set_read_timeout()), queued
+ * messages are delivered once the timeout expires, even if neither the
+ * threshold nor the delay is reached.
+ *
+ * Moderation has no effect on rendezvous channels, channels with a decoupled
+ * output, and channels connected to a routing node: the consumer of such a
+ * channel is always woken immediately.
+ *
+ * @param ch
+ *  pointer to the channel
+ * @param threshold
+ *  The number of queued messages which wake the consumer. 0 or 1 means that
+ *  only the delay is used.
+ * @param delay_us
+ *  The maximal number of microseconds the first queued message waits for the
+ *  wakeup. 0 means that the consumer waits until the threshold is reached.
+ * @return
+ *  0 on success, -1 otherwise
+ */
+int smx_channel_set_wake_moderation( smx_channel_t* ch, int threshold,
+        long delay_us );
+
 /**
  * Return a human-readable error message, give an error code.
  *
@@ -401,6 +672,17 @@ void smx_channel_terminate_sink( smx_channel_t* ch );
  */
 void smx_channel_terminate_source( smx_channel_t* ch );
 
+/**
+ * Notify the consumer of a channel that messages are available. If wakeup
+ * moderation is configured (see smx_channel_set_wake_moderation()) the read
+ * state is only set to ready once the wake threshold is reached. The first
+ * message of a batch starts the wake deadline of a blocked consumer. This must
+ * be called with the channel mutex locked.
+ *
+ * @param ch    pointer to the channel
+ */
+void smx_channel_wake_consumer( smx_channel_t* ch );
+
 /**
  * @brief Write data to an output port
  *
@@ -429,6 +711,19 @@ smx_collector_t* smx_collector_create();
  */
 void smx_collector_destroy( smx_collector_t* collector );
 
+/**
+ * Re-initialise the collector mutex. This must only be called while no net is
+ * accessing the collector.
+ *
+ * @param collector
+ *  A pointer to the collector structure.
+ * @param is_prio_inherit
+ *  If true, a mutex with priority inheritance is used, otherwise an adaptive
+ *  mutex (see smx_mutex_init()).
+ */
+void smx_collector_init_mutex( smx_collector_t* collector,
+        bool is_prio_inherit );
+
 /**
  * Send the termination signal to the collector
  *
@@ -497,7 +792,7 @@ void smx_connect_out( smx_channel_t** dest, smx_channel_t* src, smx_net_t* net,
 /**
  * @brief Create Streamix FIFO channel
  *
- * @param length    length of the FIFO
+ * @param length    length of the FIFO (0 for a FIFO without buffer space)
  * @return          pointer to the created FIFO
  */
 smx_fifo_t* smx_fifo_create( int length );
@@ -509,6 +804,28 @@ smx_fifo_t* smx_fifo_create( int length );
  */
 void smx_fifo_destroy( smx_fifo_t* fifo );
 
+/**
+ * Record the queueing delay of a FIFO item that is about to be read if the
+ * channel records the queueing delay.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param item
+ *  A pointer to the FIFO item.
+ */
+void smx_fifo_item_record_delay( smx_channel_t* ch, smx_fifo_item_t* item );
+
+/**
+ * Store the enqueue time in a FIFO item that was just written if the channel
+ * records the queueing delay.
+ *
+ * @param ch
+ *  A pointer to the channel.
+ * @param item
+ *  A pointer to the FIFO item.
+ */
+void smx_fifo_item_set_enqueue_ts( smx_channel_t* ch, smx_fifo_item_t* item );
+
 /**
  * @brief read from a Streamix FIFO channel
  *
@@ -650,6 +967,28 @@ int smx_guard_write( void* h, smx_channel_t* ch );
  */
 int smx_d_guard_write( void* h, smx_channel_t* ch, smx_msg_t* msg );
 
+/**
+ * @brief take the message handed off on a rendezvous channel
+ *
+ * @param h     pointer to the net handler
+ * @param ch    pointer to a rendezvous channel
+ * @return      pointer to the message or NULL if nothing was handed off
+ */
+smx_msg_t* smx_rendezvous_read( void* h, smx_channel_t* ch );
+
+/**
+ * @brief hand off a message to the waiting consumer of a rendezvous channel
+ *
+ * A rendezvous channel has no buffer space. A producer is blocked until a
+ * consumer is waiting for a message and the message is passed on directly.
+ *
+ * @param h     pointer to the net handler
+ * @param ch    pointer to a rendezvous channel
+ * @param msg   pointer to the message
+ * @return      0 on success, -1 otherwise
+ */
+int smx_rendezvous_write( void* h, smx_channel_t* ch, smx_msg_t* msg );
+
 /**
  * Set the channel read timeout.
  *
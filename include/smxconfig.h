@@ -77,6 +77,27 @@ int smx_config_data_maps_apply_ext_iter( bson_iter_t* i_tgt,
         bson_t* src_payload, bson_t* payload, const char* key,
         smx_config_data_maps_t* maps );
 
+/**
+ * Apply the maps incrementally. Only maps with a source value which changed
+ * since the last incremental application are applied. In base mode only the
+ * targets of the changed maps are overwritten. In extended mode the mapped
+ * payload is rebuilt if at least one source value changed and kept
+ * otherwise. Use smx_config_data_maps_is_changed() to check whether the
+ * source value of a map changed.
+ *
+ * The first incremental application considers all source values as changed.
+ *
+ * @param maps
+ *  A pointer to the initialised key map list.
+ * @param src_payload
+ *  A pointer to the source payload.
+ * @return
+ *  The number of changed maps on success, an error code on failure use
+ *  smx_config_data_map_strerror().
+ */
+int smx_config_data_maps_apply_incremental( smx_config_data_maps_t* maps,
+        bson_t* src_payload );
+
 /**
  * Free all maps allocated in a map array
  *
@@ -110,7 +131,23 @@ smx_config_data_map_t* smx_config_data_maps_get_map_by_key(
         smx_config_data_maps_t* maps, const char* key );
 
 /**
- * Initialise an input-output key map array.
+ * Grow the map item array of a mapping list. Existing map items are kept and
+ * the target path index is rebuilt if it exists.
+ *
+ * @param maps
+ *  A pointer to the mapping list.
+ * @param size
+ *  The new number of allocated map items. If this is not larger than the
+ *  current size, nothing is done.
+ * @return
+ *  0 on success, -1 on failure.
+ */
+int smx_config_data_maps_grow( smx_config_data_maps_t* maps, int size );
+
+/**
+ * Initialise an input-output key map array. The map item array is allocated
+ * to fit the number of maps and is freed by
+ * smx_config_data_maps_cleanup().
  *
  * @param i_fields
  *  The document iterator of the map list definition.
@@ -122,6 +159,19 @@ smx_config_data_map_t* smx_config_data_maps_get_map_by_key(
 int smx_config_data_maps_init( bson_iter_t* i_fields, bson_t* data,
         smx_config_data_maps_t* maps );
 
+/**
+ * Build the index of the map items by target path. The first map item of a
+ * target path takes precedence. This is called by
+ * smx_config_data_maps_init().
+ *
+ * @param maps
+ *  A pointer to the mapping list.
+ * @return
+ *  0 on success, SMX_CONFIG_MAP_ERROR_TGT_INDEX if the index cannot be
+ *  allocated.
+ */
+int smx_config_data_maps_init_tgt_index( smx_config_data_maps_t* maps );
+
 /**
  * Set a net handler to enable logging.
  *
@@ -134,7 +184,36 @@ void smx_config_data_maps_init_net_handler( smx_config_data_maps_t* maps,
         void* h );
 
 /**
- * Append a mapped value if defined in the mapping list.
+ * Check whether the source value of a map changed in the last incremental
+ * application (see smx_config_data_maps_apply_incremental()).
+ *
+ * @param maps
+ *  A pointer to the mapping list.
+ * @param key
+ *  The map key to search for.
+ * @return
+ *  True if the map exists and its source value changed, false otherwise.
+ */
+bool smx_config_data_maps_is_changed( smx_config_data_maps_t* maps,
+        const char* key );
+
+/**
+ * Resolve the source value iterator of each map item once before the maps
+ * are applied. A map item uses its own source payload if set, otherwise the
+ * source payload of the preceding map item or the given source payload.
+ *
+ * @param maps
+ *  A pointer to the mapping list.
+ * @param src_payload
+ *  A pointer to the source payload.
+ */
+void smx_config_data_maps_resolve_src( smx_config_data_maps_t* maps,
+        bson_t* src_payload );
+
+/**
+ * Append a mapped value if defined in the mapping list. The map item is
+ * looked up by target path in the index of the mapping list and its source
+ * value must have been resolved with smx_config_data_maps_resolve_src().
  *
  * @param dot_key
  *  The dot-seperated key to the target value.
@@ -284,6 +363,20 @@ int smx_config_data_map_init_tgt_doc( bson_t* payload,
 int smx_config_data_map_init_tgt_utf8( bson_t* payload,
         smx_config_data_map_t* map, const char* tgt_path, bool* is_extended );
 
+/**
+ * Compare two BSON values. Documents and arrays are compared bytewise.
+ *
+ * @param a
+ *  A pointer to the first value.
+ * @param b
+ *  A pointer to the second value.
+ * @return
+ *  True if both values are equal, false otherwise or if the type is not
+ *  supported.
+ */
+bool smx_config_data_map_is_value_equal( const bson_value_t* a,
+        const bson_value_t* b );
+
 /**
  * Return a humanreadable error string, given a an error code.
  *
@@ -294,6 +387,19 @@ int smx_config_data_map_init_tgt_utf8( bson_t* payload,
  */
 const char* smx_config_data_map_strerror( int code );
 
+/**
+ * Compare the resolved source value of a map item with the source value of
+ * the last incremental application and store a copy if it changed. The
+ * source value must have been resolved with
+ * smx_config_data_maps_resolve_src().
+ *
+ * @param map
+ *  A pointer to the map item.
+ * @return
+ *  True if the source value changed, false otherwise.
+ */
+bool smx_config_data_map_update_src_value( smx_config_data_map_t* map );
+
 /**
  * This is the same as smx_config_get_bool_err() however without the err output
  * parameter.
@@ -381,6 +487,102 @@ const char* smx_config_get_string( bson_t* conf, const char* search,
 const char* smx_config_get_string_err( bson_t* conf, const char* search,
         unsigned int* len, smx_config_error_t* err );
 
+/**
+ * Create a handle to a configuration value of a net. The value is resolved
+ * on the first read and cached such that subsequent reads do not search the
+ * configuration. If the net configuration is replaced (e.g. by a dynamic
+ * configuration) the handle resolves the value again on the next read.
+ *
+ * Use this instead of smx_config_get_int() and friends to read configuration
+ * values in the box implementation loop.
+ *
+ * @param[in] h
+ *  A pointer to the net handler.
+ * @param[in] search
+ *  A dot-notation key like "a.b.c.d". The key is copied.
+ * @param[in] type
+ *  The type of the value, i.e. `BSON_TYPE_BOOL`, `BSON_TYPE_INT32`,
+ *  `BSON_TYPE_DOUBLE`, or `BSON_TYPE_UTF8`.
+ * @return
+ *  A pointer to the handle or NULL on failure.
+ */
+smx_config_handle_t* smx_config_handle_create( void* h, const char* search,
+        bson_type_t type );
+
+/**
+ * Destroy a config handle.
+ *
+ * @param[in] handle
+ *  A pointer to the handle. NULL is ignored.
+ */
+void smx_config_handle_destroy( smx_config_handle_t* handle );
+
+/**
+ * Read a boolean value through a config handle of type `BSON_TYPE_BOOL`.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ * @return
+ *  The boolean value or false if the value is not available.
+ */
+bool smx_config_handle_get_bool( smx_config_handle_t* handle );
+
+/**
+ * Read a double value through a config handle of type `BSON_TYPE_DOUBLE`.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ * @return
+ *  The double value or 0 if the value is not available.
+ */
+double smx_config_handle_get_double( smx_config_handle_t* handle );
+
+/**
+ * Get the error of the last resolution of a config handle. This resolves
+ * the value if the cache is not valid.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ * @return
+ *  SMX_CONFIG_ERROR_NO_ERROR if the value is available, an error code
+ *  otherwise.
+ */
+smx_config_error_t smx_config_handle_get_error( smx_config_handle_t* handle );
+
+/**
+ * Read an int value through a config handle of type `BSON_TYPE_INT32`.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ * @return
+ *  The int value or 0 if the value is not available.
+ */
+int smx_config_handle_get_int( smx_config_handle_t* handle );
+
+/**
+ * Read a string value through a config handle of type `BSON_TYPE_UTF8`. The
+ * string is owned by the net configuration and is only valid until the
+ * configuration is replaced.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ * @param[out] len
+ *  An optional autput buffer to store the string length.
+ * @return
+ *  The string value or NULL if the value is not available.
+ */
+const char* smx_config_handle_get_string( smx_config_handle_t* handle,
+        unsigned int* len );
+
+/**
+ * Resolve the value of a config handle if the cache is not valid. This is
+ * called by the read functions of a handle.
+ *
+ * @param[in] handle
+ *  A pointer to the handle.
+ */
+void smx_config_handle_resolve( smx_config_handle_t* handle );
+
 /**
  * Get a boolean from the config file.
  *
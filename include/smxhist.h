@@ -0,0 +1,138 @@
+/**
+ * @file    smxhist.h
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Latency histograms for the runtime system library of Streamix
+ *
+ * The histograms use log-linear buckets, similar to HDR histograms: values
+ * below 32 have their own bucket and each power of two above is divided into
+ * 16 linear sub-buckets. This covers the full 64 bit range with 976 buckets
+ * and a relative error of at most 6.25%.
+ *
+ * A histogram has a single writer. The counters are updated with relaxed
+ * atomics such that any thread may query a histogram at runtime without
+ * locking. A query taken while values are recorded is not an exact snapshot.
+ */
+
+#include <stdint.h>
+#include "smxtypes.h"
+
+#ifndef SMXHIST_H
+#define SMXHIST_H
+
+/** The number of sub-bucket bits per power of two */
+#define SMX_HIST_SUB_BITS 4
+/** The number of sub-buckets per power of two */
+#define SMX_HIST_SUB_COUNT ( 1 << SMX_HIST_SUB_BITS )
+/** The number of buckets to cover 64 bit values */
+#define SMX_HIST_BUCKETS\
+    ( ( 64 - SMX_HIST_SUB_BITS ) * SMX_HIST_SUB_COUNT + SMX_HIST_SUB_COUNT )
+
+/**
+ * A log-linear histogram.
+ */
+struct smx_hist_s
+{
+    uint64_t count;     /**< the number of recorded values */
+    uint64_t sum;       /**< the sum of all recorded values */
+    uint64_t min;       /**< the smallest recorded value */
+    uint64_t max;       /**< the largest recorded value */
+    uint64_t buckets[SMX_HIST_BUCKETS]; /**< the value counts per bucket */
+};
+
+/**
+ * Create an empty histogram.
+ *
+ * @return
+ *  A pointer to the histogram or NULL on failure.
+ */
+smx_hist_t* smx_hist_create();
+
+/**
+ * Destroy a histogram.
+ *
+ * @param hist
+ *  A pointer to the histogram. NULL is ignored.
+ */
+void smx_hist_destroy( smx_hist_t* hist );
+
+/**
+ * Get the bucket index of a value.
+ *
+ * @param val
+ *  The value.
+ * @return
+ *  The index of the bucket holding the value.
+ */
+int smx_hist_get_bucket_idx( uint64_t val );
+
+/**
+ * Get the largest value of a bucket.
+ *
+ * @param idx
+ *  The bucket index.
+ * @return
+ *  The largest value which falls into the bucket.
+ */
+uint64_t smx_hist_get_bucket_max( int idx );
+
+/**
+ * Get the mean of all recorded values.
+ *
+ * @param hist
+ *  A pointer to the histogram.
+ * @return
+ *  The mean or 0 if no value was recorded.
+ */
+double smx_hist_get_mean( smx_hist_t* hist );
+
+/**
+ * Get a percentile of the recorded values. The returned value is the largest
+ * value of the bucket holding the percentile, limited by the largest recorded
+ * value.
+ *
+ * @param hist
+ *  A pointer to the histogram.
+ * @param percentile
+ *  The percentile in the range [0, 100], e.g. 99.9.
+ * @return
+ *  The value at the percentile or 0 if no value was recorded.
+ */
+uint64_t smx_hist_get_percentile( smx_hist_t* hist, double percentile );
+
+/**
+ * Log a summary of the histogram with the count, the mean, the percentiles
+ * p50, p99, p99.9, and the maximum.
+ *
+ * @param hist
+ *  A pointer to the histogram.
+ * @param cat
+ *  The zlog category to log to.
+ * @param name
+ *  The name of the histogram, used as log prefix.
+ */
+void smx_hist_log( smx_hist_t* hist, zlog_category_t* cat, const char* name );
+
+/**
+ * Record a value. This must only be called by one thread.
+ *
+ * @param hist
+ *  A pointer to the histogram. NULL is ignored.
+ * @param val
+ *  The value to record.
+ */
+void smx_hist_record( smx_hist_t* hist, uint64_t val );
+
+/**
+ * Remove all recorded values.
+ *
+ * @param hist
+ *  A pointer to the histogram.
+ */
+void smx_hist_reset( smx_hist_t* hist );
+
+#endif /* SMXHIST_H */
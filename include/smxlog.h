@@ -7,10 +7,32 @@
  *  You can obtain one at https://mozilla.org/MPL/2.0/.
  *
  * Log definitions for the runtime system library of Streamix
+ *
+ * If the library is built with `make async-log` (`SMX_LOG_ASYNC`), log calls
+ * do not enter zlog. Instead, each thread writes compact binary records
+ * holding the format string pointer and the arguments to its own
+ * single-producer single-consumer ring. The producer never blocks: if the
+ * ring is full the record is dropped and counted. A background thread
+ * periodically formats the records and forwards them to zlog.
+ *
+ * Log calls below a minimal level can be compiled out per category by
+ * defining `SMX_LOG_MIN_LEVEL_MAIN`, `SMX_LOG_MIN_LEVEL_MSG`,
+ * `SMX_LOG_MIN_LEVEL_CH`, or `SMX_LOG_MIN_LEVEL_NET`, e.g.
+ * `make SMX_LOG_MIN_LEVEL_CH=ZLOG_LEVEL_WARN`. The channel and net categories
+ * apply to SMX_LOG_CH() and SMX_LOG_NET() as well. In addition, channels and
+ * nets cache the lowest enabled level of their zlog category such that
+ * disabled log calls neither evaluate their arguments nor enter zlog.
+ *
+ * A record holds at most #SMX_LOG_RING_MAX_ARGS arguments. String arguments
+ * are copied into the record and truncated to #SMX_LOG_RING_STR_SIZE bytes in
+ * total. The format string must be a string literal and must not use `*`
+ * width or precision arguments.
  */
 
 #include <zlog.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #ifndef SMXLOG_H
 #define SMXLOG_H
@@ -18,6 +40,110 @@
 /** The custom zlog level "event" */
 #define ZLOG_LEVEL_EVENT 50
 
+/** The number of log records per thread ring */
+#define SMX_LOG_RING_SIZE 512
+/** The maximal number of arguments of a log record */
+#define SMX_LOG_RING_MAX_ARGS 10
+/** The size of the string buffer of a log record */
+#define SMX_LOG_RING_STR_SIZE 96
+/** The maximal length of a formatted log line */
+#define SMX_LOG_RING_LINE_LEN 1024
+/** The flush interval of the log thread in milliseconds */
+#define SMX_LOG_RING_FLUSH_INTERVAL_MS 10
+
+/** The zlog levels by the names used in the logger macros */
+#define SMX_LOG_LEVEL_debug ZLOG_LEVEL_DEBUG
+#define SMX_LOG_LEVEL_info ZLOG_LEVEL_INFO
+#define SMX_LOG_LEVEL_event ZLOG_LEVEL_EVENT
+#define SMX_LOG_LEVEL_notice ZLOG_LEVEL_NOTICE
+#define SMX_LOG_LEVEL_warn ZLOG_LEVEL_WARN
+#define SMX_LOG_LEVEL_error ZLOG_LEVEL_ERROR
+#define SMX_LOG_LEVEL_fatal ZLOG_LEVEL_FATAL
+
+#ifndef SMX_LOG_MIN_LEVEL_MAIN
+/** The lowest log level of the main category compiled into the library */
+#define SMX_LOG_MIN_LEVEL_MAIN 0
+#endif
+#ifndef SMX_LOG_MIN_LEVEL_MSG
+/** The lowest log level of the msg category compiled into the library */
+#define SMX_LOG_MIN_LEVEL_MSG 0
+#endif
+#ifndef SMX_LOG_MIN_LEVEL_CH
+/** The lowest log level of channel categories compiled into the library */
+#define SMX_LOG_MIN_LEVEL_CH 0
+#endif
+#ifndef SMX_LOG_MIN_LEVEL_NET
+/** The lowest log level of net categories compiled into the library */
+#define SMX_LOG_MIN_LEVEL_NET 0
+#endif
+
+/** The lowest compiled log levels by the names used in SMX_LOG_MAIN() */
+#define SMX_LOG_MIN_LEVEL_main SMX_LOG_MIN_LEVEL_MAIN
+#define SMX_LOG_MIN_LEVEL_msg SMX_LOG_MIN_LEVEL_MSG
+#define SMX_LOG_MIN_LEVEL_ch SMX_LOG_MIN_LEVEL_CH
+#define SMX_LOG_MIN_LEVEL_net SMX_LOG_MIN_LEVEL_NET
+
+typedef enum smx_log_arg_type_e smx_log_arg_type_t;
+typedef struct smx_log_arg_s smx_log_arg_t;
+typedef struct smx_log_record_s smx_log_record_t;
+typedef struct smx_log_ring_s smx_log_ring_t;
+
+/**
+ * The argument types of a log record.
+ */
+enum smx_log_arg_type_e
+{
+    SMX_LOG_ARG_INT,    /**< any integer type */
+    SMX_LOG_ARG_DOUBLE, /**< any floating point type */
+    SMX_LOG_ARG_PTR,    /**< any pointer which is not a string */
+    SMX_LOG_ARG_STR     /**< a string, copied into the record */
+};
+
+/**
+ * An argument of a log record.
+ */
+struct smx_log_arg_s
+{
+    smx_log_arg_type_t type;    /**< the argument type */
+    union {
+        long long   i;          /**< #SMX_LOG_ARG_INT */
+        double      d;          /**< #SMX_LOG_ARG_DOUBLE */
+        const void* p;          /**< #SMX_LOG_ARG_PTR */
+        const char* s;          /**< #SMX_LOG_ARG_STR */
+    };
+};
+
+/**
+ * A binary log record. String arguments point into `strs`.
+ */
+struct smx_log_record_s
+{
+    zlog_category_t*    cat;        /**< the zlog category */
+    const char*         file;       /**< the source file of the log call */
+    const char*         func;       /**< the function of the log call */
+    const char*         format;     /**< the format string */
+    int                 line;       /**< the source line of the log call */
+    int                 level;      /**< the zlog level */
+    int                 arg_count;  /**< the number of arguments */
+    smx_log_arg_t       args[SMX_LOG_RING_MAX_ARGS]; /**< the arguments */
+    char                strs[SMX_LOG_RING_STR_SIZE]; /**< the string args */
+};
+
+/**
+ * A single-producer single-consumer ring of log records. The producer only
+ * writes `head`, the consumer only writes `tail`.
+ */
+struct smx_log_ring_s
+{
+    uint64_t            head __attribute__(( aligned( 64 ) ));
+    uint64_t            tail __attribute__(( aligned( 64 ) ));
+    uint64_t            drop_count; /**< records dropped by the producer */
+    uint64_t            drop_report; /**< the last reported drop count */
+    uint64_t            mask;       /**< the ring size minus one */
+    smx_log_record_t*   records;    /**< the log records */
+    smx_log_ring_t*     next;       /**< the next ring of the ring list */
+};
+
 /**
  * The macro to use the custom zlog level "event".
  */
@@ -33,6 +159,8 @@
 #define SMX_LOG_INTERN SMX_LOG_MUTEX
 #elif defined(SMX_LOG_DISABLE)
 #define SMX_LOG_INTERN SMX_LOG_NOOP
+#elif defined(SMX_LOG_ASYNC)
+#define SMX_LOG_INTERN SMX_LOG_RING
 #else
 #define SMX_LOG_INTERN SMX_LOG_FREE
 #endif
@@ -42,8 +170,11 @@
  *
  * The logger macro for channel-specific logs.
  */
-#define SMX_LOG_CH( ch, level, format, ... )\
-    SMX_LOG_INTERN( level, ch->cat, format,  ##__VA_ARGS__ )
+#define SMX_LOG_CH( ch, level, format, ... ) do {\
+    if( SMX_LOG_LEVEL_ ## level >= SMX_LOG_MIN_LEVEL_CH\
+            && SMX_LOG_LEVEL_ ## level >= ch->log_level )\
+        SMX_LOG_INTERN( level, ch->cat, format,  ##__VA_ARGS__ );\
+    } while( 0 )
 
 /**
  * @def SMX_LOG_MUTEX()
@@ -72,20 +203,92 @@
 #define SMX_LOG_NOOP( level, cat, format, ... )\
     do {} while(0)
 
+/**
+ * @def SMX_LOG_RING()
+ *
+ * The logger macro writing a binary record to the ring of the calling thread.
+ * A dummy argument is prepended such that the argument array is never empty.
+ */
+#define SMX_LOG_RING( level, cat, format, ... ) do {\
+    smx_log_arg_t smx_log_args[] = { SMX_LOG_ARGS( 0, ##__VA_ARGS__ ) };\
+    smx_log_ring_write( cat, SMX_LOG_LEVEL_ ## level, __FILE__, __func__,\
+            __LINE__, format, smx_log_args + 1,\
+            sizeof( smx_log_args ) / sizeof( smx_log_arg_t ) - 1 );\
+    } while( 0 )
+
+/**
+ * @def SMX_LOG_ARG()
+ *
+ * Convert a log argument to a ::smx_log_arg_s depending on its type.
+ */
+#define SMX_LOG_ARG( x ) _Generic( ( x ),\
+    _Bool: smx_log_arg_int,\
+    char: smx_log_arg_int,\
+    signed char: smx_log_arg_int,\
+    unsigned char: smx_log_arg_int,\
+    short: smx_log_arg_int,\
+    unsigned short: smx_log_arg_int,\
+    int: smx_log_arg_int,\
+    unsigned int: smx_log_arg_int,\
+    long: smx_log_arg_int,\
+    unsigned long: smx_log_arg_int,\
+    long long: smx_log_arg_int,\
+    unsigned long long: smx_log_arg_int,\
+    float: smx_log_arg_double,\
+    double: smx_log_arg_double,\
+    long double: smx_log_arg_double,\
+    char*: smx_log_arg_str,\
+    const char*: smx_log_arg_str,\
+    default: smx_log_arg_ptr )( x )
+
+/**
+ * @def SMX_LOG_ARGS()
+ *
+ * Apply SMX_LOG_ARG() to at most #SMX_LOG_RING_MAX_ARGS + 1 arguments.
+ */
+#define SMX_LOG_ARGS( ... ) SMX_LOG_ARGS_N( SMX_LOG_ARGS_COUNT( __VA_ARGS__ ),\
+        __VA_ARGS__ )
+#define SMX_LOG_ARGS_N( n, ... ) SMX_LOG_ARGS_CAT( n, __VA_ARGS__ )
+#define SMX_LOG_ARGS_CAT( n, ... ) SMX_LOG_ARGS_ ## n( __VA_ARGS__ )
+#define SMX_LOG_ARGS_COUNT( ... ) SMX_LOG_ARGS_SEL( __VA_ARGS__, 11, 10, 9,\
+        8, 7, 6, 5, 4, 3, 2, 1 )
+#define SMX_LOG_ARGS_SEL( _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, n,\
+        ... ) n
+#define SMX_LOG_ARGS_1( x ) SMX_LOG_ARG( x )
+#define SMX_LOG_ARGS_2( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_1( __VA_ARGS__ )
+#define SMX_LOG_ARGS_3( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_2( __VA_ARGS__ )
+#define SMX_LOG_ARGS_4( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_3( __VA_ARGS__ )
+#define SMX_LOG_ARGS_5( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_4( __VA_ARGS__ )
+#define SMX_LOG_ARGS_6( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_5( __VA_ARGS__ )
+#define SMX_LOG_ARGS_7( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_6( __VA_ARGS__ )
+#define SMX_LOG_ARGS_8( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_7( __VA_ARGS__ )
+#define SMX_LOG_ARGS_9( x, ... ) SMX_LOG_ARG( x ), SMX_LOG_ARGS_8( __VA_ARGS__ )
+#define SMX_LOG_ARGS_10( x, ... ) SMX_LOG_ARG( x ),\
+    SMX_LOG_ARGS_9( __VA_ARGS__ )
+#define SMX_LOG_ARGS_11( x, ... ) SMX_LOG_ARG( x ),\
+    SMX_LOG_ARGS_10( __VA_ARGS__ )
+
 /**
  * @def SMX_LOG_MAIN( cat, level, format, ... )
  * A macro to log to a globally defined category `cat` on log level `level`.
  */
-#define SMX_LOG_MAIN( cat, level, format, ... )\
-    SMX_LOG_INTERN( level, smx_get_zcat_ ## cat(), format,  ##__VA_ARGS__ )
+#define SMX_LOG_MAIN( cat, level, format, ... ) do {\
+    if( SMX_LOG_LEVEL_ ## level >= SMX_LOG_MIN_LEVEL_ ## cat )\
+        SMX_LOG_INTERN( level, smx_get_zcat_ ## cat(), format,\
+                ##__VA_ARGS__ );\
+    } while( 0 )
 
 /**
  * @def SMX_LOG_NET()
  *
  * Refer top SMX_LOG() for more information.
  */
-#define SMX_LOG_NET( net, level, format, ... )\
-    SMX_LOG_INTERN( level, SMX_SIG_CAT( net ), format, ##__VA_ARGS__ )
+#define SMX_LOG_NET( net, level, format, ... ) do {\
+    if( SMX_LOG_LEVEL_ ## level >= SMX_LOG_MIN_LEVEL_NET\
+            && ( net == NULL || SMX_LOG_LEVEL_ ## level\
+                >= ( ( smx_net_t* )net )->log_level ) )\
+        SMX_LOG_INTERN( level, SMX_SIG_CAT( net ), format, ##__VA_ARGS__ );\
+    } while( 0 )
 
 /**
  * Define mutex protection and main categories for zlog. Further, initialise
@@ -97,10 +300,183 @@
 int smx_log_init( const char* log_conf );
 
 /**
- * Cleanup zlog
+ * Cleanup zlog. If the log thread is running it is stopped and all pending
+ * log records are flushed first.
  */
 void smx_log_cleanup();
 
+/**
+ * Create a log argument from a floating point value.
+ *
+ * @param val
+ *  The value.
+ * @return
+ *  The log argument.
+ */
+smx_log_arg_t smx_log_arg_double( long double val );
+
+/**
+ * Create a log argument from an integer value.
+ *
+ * @param val
+ *  The value.
+ * @return
+ *  The log argument.
+ */
+smx_log_arg_t smx_log_arg_int( long long val );
+
+/**
+ * Create a log argument from a pointer.
+ *
+ * @param val
+ *  The pointer.
+ * @return
+ *  The log argument.
+ */
+smx_log_arg_t smx_log_arg_ptr( const void* val );
+
+/**
+ * Create a log argument from a string. The string is only copied once the
+ * record is written to a ring.
+ *
+ * @param val
+ *  The string.
+ * @return
+ *  The log argument.
+ */
+smx_log_arg_t smx_log_arg_str( const char* val );
+
+/**
+ * Get the lowest log level which is enabled for a zlog category.
+ *
+ * @param cat
+ *  A pointer to the zlog category.
+ * @return
+ *  The lowest enabled zlog level or a level above #ZLOG_LEVEL_FATAL if the
+ *  category is NULL or all levels are disabled.
+ */
+int smx_log_get_level( zlog_category_t* cat );
+
+/**
+ * Re-initialise the global zlog mutex. By default the mutex uses priority
+ * inheritance. This must only be called while no other thread is logging.
+ *
+ * @param is_prio_inherit
+ *  If true, a mutex with priority inheritance is created, otherwise an
+ *  adaptive mutex.
+ */
+void smx_log_init_mutex( bool is_prio_inherit );
+
+/**
+ * Create a log ring and append it to the list of rings drained by the log
+ * thread.
+ *
+ * @param size
+ *  The number of records, rounded up to the next power of two.
+ * @return
+ *  A pointer to the ring or NULL on failure.
+ */
+smx_log_ring_t* smx_log_ring_create( int size );
+
+/**
+ * Destroy a log ring.
+ *
+ * @param ring
+ *  A pointer to the ring. NULL is ignored.
+ */
+void smx_log_ring_destroy( smx_log_ring_t* ring );
+
+/**
+ * Format a log record and forward it to zlog.
+ *
+ * @param record
+ *  A pointer to the log record.
+ */
+void smx_log_ring_emit( smx_log_record_t* record );
+
+/**
+ * Forward all pending records of all rings to zlog and report dropped
+ * records. This must only be called by one thread at a time.
+ */
+void smx_log_ring_flush();
+
+/**
+ * Format a log record. The conversion specifications of the format string are
+ * formatted one by one with the arguments of the record.
+ *
+ * @param record
+ *  A pointer to the log record.
+ * @param buf
+ *  The buffer to write to.
+ * @param len
+ *  The size of the buffer.
+ * @return
+ *  The length of the formatted string.
+ */
+int smx_log_ring_format( smx_log_record_t* record, char* buf, size_t len );
+
+/**
+ * The start routine of the log thread.
+ *
+ * @param arg
+ *  Unused.
+ * @return
+ *  This function always returns NULL.
+ */
+void* smx_log_ring_run( void* arg );
+
+/**
+ * Start the log thread.
+ *
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_log_ring_start();
+
+/**
+ * Stop the log thread, flush all pending records, and destroy all rings.
+ * This must only be called while no other thread is logging.
+ */
+void smx_log_ring_stop();
+
+/**
+ * Create the log ring of the calling thread if the log thread is running and
+ * the calling thread has no ring yet. Threads with real-time constraints call
+ * this when they start such that the first log call does not allocate the
+ * ring.
+ *
+ * @return
+ *  0 on success or if no ring is required, -1 if the ring cannot be created.
+ */
+int smx_log_ring_thread_init();
+
+/**
+ * Write a log record to the ring of the calling thread. If the thread did not
+ * create its ring with smx_log_ring_thread_init(), the ring is created on the
+ * first call of the thread. If the log thread is not running, the record
+ * is forwarded to zlog immediately.
+ *
+ * @param cat
+ *  The zlog category.
+ * @param level
+ *  The zlog level.
+ * @param file
+ *  The source file of the log call.
+ * @param func
+ *  The function of the log call.
+ * @param line
+ *  The source line of the log call.
+ * @param format
+ *  The format string. This must be a string literal.
+ * @param args
+ *  The arguments of the format string.
+ * @param arg_count
+ *  The number of arguments.
+ */
+void smx_log_ring_write( zlog_category_t* cat, int level, const char* file,
+        const char* func, int line, const char* format, smx_log_arg_t* args,
+        int arg_count );
+
 /**
  * Get the global zlog mutex handler
  *
@@ -0,0 +1,330 @@
+/**
+ * @file    smxmetrics.h
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Live metrics for the runtime system library of Streamix
+ *
+ * The RTS publishes per-net and per-channel counters in a POSIX shared-memory
+ * segment. The segment is enabled with the top-level key `_metrics` of the
+ * app configuration:
+ *
+ * ```
+ * "_metrics": {
+ *     "shm_name": "/smx-app",
+ *     "socket": "/run/smx-app.sock",
+ *     "port": 9464
+ * }
+ * ```
+ *
+ * If `shm_name` is omitted the segment is named `/smx-<pid>`. With `"shm":
+ * false` the records are kept in private memory and no segment is created.
+ *
+ * The segment consists of a header (::smx_metrics_header_s) followed by
+ * `net_count` net records (::smx_metrics_net_s) and `ch_count` channel records
+ * (::smx_metrics_ch_s). Each record is written by the threads of the
+ * application with relaxed atomic stores. A reader (e.g. `smx-top`) must load
+ * the fields with relaxed atomic loads and must not expect the fields of a
+ * record to be mutually consistent.
+ *
+ * If `socket` (a Unix domain socket path) or `port` (a TCP port on the
+ * loopback interface) is set, a metrics thread serves the counters in the
+ * Prometheus text exposition format to HTTP GET requests, e.g.
+ * `curl --unix-socket /run/smx-app.sock http://localhost/metrics`. Nets and
+ * channels are identified by the labels `name` and `id`. The histograms of
+ * nets and channels are served as summaries.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "smxtypes.h"
+
+#ifndef SMXMETRICS_H
+#define SMXMETRICS_H
+
+/** The magic string at the start of a metrics segment */
+#define SMX_METRICS_MAGIC "SMXMETRC"
+/** The version of the metrics segment layout */
+#define SMX_METRICS_VERSION 1
+/** The maximal length of a net or channel name, including termination */
+#define SMX_METRICS_NAME_LEN 48
+/** The poll interval of the metrics thread in milliseconds */
+#define SMX_METRICS_POLL_INTERVAL_MS 100
+/** The maximal size of a request to the metrics endpoint */
+#define SMX_METRICS_REQUEST_LEN 1024
+
+typedef enum smx_metrics_net_state_e smx_metrics_net_state_t;
+typedef struct smx_metrics_header_s smx_metrics_header_t;
+
+/**
+ * The execution state of a net as published in the metrics segment.
+ */
+enum smx_metrics_net_state_e
+{
+    SMX_METRICS_NET_INIT,           /**< the net is initialising */
+    SMX_METRICS_NET_RUN,            /**< the net is running */
+    SMX_METRICS_NET_BLOCKED_READ,   /**< the net waits for an input */
+    SMX_METRICS_NET_BLOCKED_WRITE,  /**< the net waits for output space */
+    SMX_METRICS_NET_END             /**< the net has terminated */
+};
+
+/**
+ * The header of a metrics segment.
+ */
+struct smx_metrics_header_s
+{
+    char        magic[8];       /**< #SMX_METRICS_MAGIC without termination */
+    uint32_t    version;        /**< #SMX_METRICS_VERSION */
+    uint32_t    header_size;    /**< the size of the header in bytes */
+    uint32_t    net_size;       /**< the size of a net record in bytes */
+    uint32_t    ch_size;        /**< the size of a channel record in bytes */
+    uint32_t    net_count;      /**< the number of net records */
+    uint32_t    ch_count;       /**< the number of channel records */
+    int32_t     pid;            /**< the process id of the application */
+    uint32_t    reserved;       /**< unused, always 0 */
+    uint64_t    start_ts;       /**< CLOCK_MONOTONIC start time in ns */
+} __attribute__(( aligned( 64 ) ));
+
+/**
+ * The counters of a net. A record is only written by the thread of the net.
+ */
+struct smx_metrics_net_s
+{
+    char        name[SMX_METRICS_NAME_LEN]; /**< the name of the net */
+    int32_t     id;             /**< the id of the net */
+    int32_t     state;          /**< #smx_metrics_net_state_e */
+    uint64_t    count;          /**< the loop count */
+    uint64_t    impl_time;      /**< the last box implementation time in ns */
+    uint64_t    impl_time_sum;  /**< the sum of all implementation times */
+    int32_t     expected_rate;  /**< the configured expected rate or 0 */
+    int32_t     reserved;       /**< unused, always 0 */
+} __attribute__(( aligned( 64 ) ));
+
+/**
+ * The counters of a channel. A record is written by the producer and the
+ * consumer of the channel while holding the channel mutex.
+ */
+struct smx_metrics_ch_s
+{
+    char        name[SMX_METRICS_NAME_LEN]; /**< the name of the channel */
+    int32_t     id;             /**< the id of the channel */
+    int32_t     writer_net_id;  /**< the id of the producer or -1 */
+    int32_t     reader_net_id;  /**< the id of the consumer or -1 */
+    int32_t     length;         /**< the length of the FIFO */
+    int32_t     count;          /**< the number of queued messages */
+    int32_t     overwrite;      /**< the number of overwritten messages */
+    int32_t     copy;           /**< the number of duplicated messages */
+    int32_t     read_err;       /**< the last #smx_channel_err_e of a read */
+    int32_t     write_err;      /**< the last #smx_channel_err_e of a write */
+    int32_t     reserved;       /**< unused, always 0 */
+    uint64_t    read_count;     /**< the number of read operations */
+    uint64_t    write_count;    /**< the number of write operations */
+    uint64_t    read_block_time;    /**< the time the consumer blocked in ns */
+    uint64_t    write_block_time;   /**< the time the producer blocked in ns */
+} __attribute__(( aligned( 64 ) ));
+
+/**
+ * The metrics structure.
+ */
+struct smx_metrics_s
+{
+    char*                   shm_name;   /**< the name of the segment */
+    int                     fd;         /**< the file descriptor */
+    size_t                  size;       /**< the size of the segment */
+    uint8_t*                map;        /**< the mapped segment */
+    smx_metrics_header_t*   header;     /**< the segment header */
+    smx_metrics_net_t*      nets;       /**< the net records */
+    smx_metrics_ch_t*       chs;        /**< the channel records */
+    bool                    has_shm;    /**< is the segment shared? */
+    char*                   socket_path; /**< the endpoint socket or NULL */
+    int                     port;       /**< the endpoint port or 0 */
+    int                     server_fd;  /**< the listening socket or -1 */
+    bool                    is_serving; /**< is the metrics thread running? */
+    pthread_t               th;         /**< the metrics thread */
+    smx_rts_t*              rts;        /**< the RTS structure */
+};
+
+/**
+ * Create a metrics structure from the `_metrics` key of the app
+ * configuration. The segment is only created once the number of nets and
+ * channels is known (see smx_metrics_start()).
+ *
+ * @param conf
+ *  A pointer to the app configuration.
+ * @return
+ *  A pointer to the metrics structure or NULL if metrics are disabled.
+ */
+smx_metrics_t* smx_metrics_create( bson_t* conf );
+
+/**
+ * Unmap and unlink the metrics segment and destroy the metrics structure.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure. NULL is ignored.
+ */
+void smx_metrics_destroy( smx_metrics_t* metrics );
+
+/**
+ * Get the size of the metrics segment.
+ *
+ * @param net_count
+ *  The number of net records.
+ * @param ch_count
+ *  The number of channel records.
+ * @return
+ *  The size of the segment in bytes.
+ */
+size_t smx_metrics_get_size( int net_count, int ch_count );
+
+/**
+ * Handle a request to the metrics endpoint. The request is read and answered
+ * with the Prometheus text exposition of all counters.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure.
+ * @param fd
+ *  The socket of the accepted connection.
+ */
+void smx_metrics_server_handle( smx_metrics_t* metrics, int fd );
+
+/**
+ * Open the listening socket of the metrics endpoint.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_metrics_server_open( smx_metrics_t* metrics );
+
+/**
+ * The start routine of the metrics thread.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure.
+ * @return
+ *  This function always returns NULL.
+ */
+void* smx_metrics_server_run( void* metrics );
+
+/**
+ * Publish the execution state of a net.
+ *
+ * @param h
+ *  A pointer to the net handler. If NULL or if the net has no metrics record,
+ *  nothing is done.
+ * @param state
+ *  The new state.
+ */
+void smx_metrics_set_net_state( smx_net_t* h, smx_metrics_net_state_t state );
+
+/**
+ * Create and map the metrics segment, initialise a record for each net and
+ * channel, and attach the records to the nets and channels. This must be
+ * called after all nets were created and connected and before the net threads
+ * are started.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure. NULL is ignored.
+ * @param rts
+ *  A pointer to the RTS structure.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_metrics_start( smx_metrics_t* metrics, smx_rts_t* rts );
+
+/**
+ * Stop the metrics thread and close the endpoint. This must be called before
+ * the nets and channels are destroyed. The shared memory segment remains
+ * available until smx_metrics_destroy() is called.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure. NULL is ignored.
+ */
+void smx_metrics_stop( smx_metrics_t* metrics );
+
+/**
+ * Publish the counters of a channel after a read or write operation. This
+ * must be called while holding the channel mutex.
+ *
+ * @param ch
+ *  A pointer to the channel. If the channel has no metrics record, nothing is
+ *  done.
+ * @param is_read
+ *  True if the operation was a read, false if it was a write.
+ */
+void smx_metrics_update_ch( smx_channel_t* ch, bool is_read );
+
+/**
+ * Publish the counters of a net after a call of the box implementation. This
+ * must only be called by the thread of the net.
+ *
+ * @param h
+ *  A pointer to the net handler. If the net has no metrics record, nothing is
+ *  done.
+ * @param impl_time
+ *  The execution time of the box implementation in nanoseconds.
+ */
+void smx_metrics_update_net( smx_net_t* h, uint64_t impl_time );
+
+/**
+ * Write the header lines of a Prometheus metric family.
+ *
+ * @param f
+ *  The stream to write to.
+ * @param name
+ *  The name of the metric family.
+ * @param type
+ *  The Prometheus type, i.e. `counter`, `gauge`, or `summary`.
+ * @param help
+ *  The help text.
+ */
+void smx_metrics_write_family( FILE* f, const char* name, const char* type,
+        const char* help );
+
+/**
+ * Write the identifying labels of a net or a channel without braces, e.g.
+ * `name="src",id="2"`. Quotes, backslashes, and newlines in the name are
+ * escaped.
+ *
+ * @param f
+ *  The stream to write to.
+ * @param name
+ *  The name of the net or channel.
+ * @param id
+ *  The id of the net or channel.
+ */
+void smx_metrics_write_labels( FILE* f, const char* name, int id );
+
+/**
+ * Write the Prometheus text exposition of all net and channel counters.
+ *
+ * @param metrics
+ *  A pointer to the metrics structure.
+ * @param f
+ *  The stream to write to.
+ */
+void smx_metrics_write_prometheus( smx_metrics_t* metrics, FILE* f );
+
+/**
+ * Write the samples of a histogram as Prometheus summary with the quantiles
+ * 0.5, 0.9, 0.99, and 0.999 in seconds.
+ *
+ * @param f
+ *  The stream to write to.
+ * @param family
+ *  The name of the metric family.
+ * @param name
+ *  The name of the net or channel.
+ * @param id
+ *  The id of the net or channel.
+ * @param hist
+ *  A pointer to the histogram. If NULL, nothing is written.
+ */
+void smx_metrics_write_summary( FILE* f, const char* family, const char* name,
+        int id, smx_hist_t* hist );
+
+#endif /* SMXMETRICS_H */
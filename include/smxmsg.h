@@ -31,6 +31,15 @@
 #define SMX_MSG_CREATE( h, data, dsize, fcopy, ffree, funpack )\
     smx_msg_create( h, data, dsize, fcopy, ffree, funpack )
 
+/**
+ * @def SMX_MSG_CREATE_FROM()
+ *
+ * Create a message structure derived from another message. For details refer
+ * to smx_msg_create_from().
+ */
+#define SMX_MSG_CREATE_FROM( h, parent, data, dsize, fcopy, ffree, funpack )\
+    smx_msg_create_from( h, parent, data, dsize, fcopy, ffree, funpack )
+
 /**
  * @def SMX_MSG_DESTROY()
  *
@@ -73,9 +82,38 @@
 #define SMX_MSG_PREVENT_BACKUP( msg )\
     smx_msg_prevent_backup( msg )
 
+/**
+ * @def SMX_MSG_INHERIT_ORIGIN()
+ *
+ * Let a message derived from another message inherit its origin timestamp.
+ * For details refer to smx_msg_inherit_origin().
+ */
+#define SMX_MSG_INHERIT_ORIGIN( msg, parent )\
+    smx_msg_inherit_origin( msg, parent )
+
+/**
+ * @def SMX_MSG_SET_PARTITION_KEY()
+ *
+ * Set the partition key of a message. For details refer to
+ * smx_msg_set_partition_key().
+ */
+#define SMX_MSG_SET_PARTITION_KEY( msg, key )\
+    smx_msg_set_partition_key( msg, key )
+
+/**
+ * @def SMX_MSG_SET_PARTITION_KEY_STR()
+ *
+ * Set the partition key of a message from a string. For details refer to
+ * smx_msg_set_partition_key_str().
+ */
+#define SMX_MSG_SET_PARTITION_KEY_STR( msg, key )\
+    smx_msg_set_partition_key_str( msg, key )
+
 /**
  * @brief make a deep copy of a message
  *
+ * The copy inherits the origin time of the message.
+ *
  * @param h     pointer to the net handler
  * @param msg   pointer to the message structure to copy
  * @return      pointer to the newly created message structure
@@ -87,7 +125,8 @@ smx_msg_t* smx_msg_copy( void* h, smx_msg_t* msg );
  *
  * Allows to create a message structure and attach handlers to modify the data
  * in the message structure. If defined, the init function handler is called
- * after the message structure is created.
+ * after the message structure is created. The creation time is stored in the
+ * message and also serves as its origin time (see smx_msg_inherit_origin()).
  *
  * @param h
  *  pointer to the net handler
@@ -119,6 +158,42 @@ smx_msg_t* smx_msg_create( void* h, void* data, size_t size,
         void* (*copy)( void* data, size_t size ), void (*destroy)( void* data ),
         void* (*unpack)( void* data ) );
 
+/**
+ * Create a message structure derived from another message. This is the same
+ * as smx_msg_create() but the new message inherits the origin time (see
+ * smx_msg_inherit_origin()) and the trace sampling decision of the parent
+ * message.
+ *
+ * If no parent is given, the message is selected for tracing according to
+ * the net property `profiler_sample_rate` N of the creating net: only every
+ * N-th message created by the net is traced by the profiler. The decision is
+ * kept by all copies and derived messages such that a selected message is
+ * traced through all channels and nets.
+ *
+ * @param h
+ *  pointer to the net handler
+ * @param parent
+ *  a pointer to the message the new message is derived from or NULL
+ * @param data
+ *  a pointer to the data to be added to the message
+ * @param size
+ *  the size of the data
+ * @param copy
+ *  a pointer to a function perfroming a deep copy of the data (see
+ *  smx_msg_create())
+ * @param destroy
+ *  a pointer to a function freeing the memory of the data (see
+ *  smx_msg_create())
+ * @param unpack
+ *  a pointer to a function that unpacks the message data (see
+ *  smx_msg_create())
+ * @return
+ *  a pointer to the created message structure
+ */
+smx_msg_t* smx_msg_create_from( void* h, smx_msg_t* parent, void* data,
+        size_t size, void* (*copy)( void* data, size_t size ),
+        void (*destroy)( void* data ), void* (*unpack)( void* data ) );
+
 /**
  * @brief Default copy function to perform a shallow copy of the message data
  *
@@ -181,6 +256,32 @@ void smx_msg_destroy( void* h, smx_msg_t* msg, int deep );
  */
 void smx_msg_prevent_backup( smx_msg_t* msg );
 
+/**
+ * Get the end-to-end latency of a message, i.e. the time elapsed since the
+ * origin time of the message.
+ *
+ * @param msg
+ *  A pointer to the message.
+ * @return
+ *  The latency in nanoseconds.
+ */
+uint64_t smx_msg_get_latency( smx_msg_t* msg );
+
+/**
+ * Set the origin time of a message to the origin time of another message. A
+ * box should call this on messages derived from an input message such that
+ * the end-to-end latency is measured from the creation of the first message
+ * in the chain. Message copies inherit the origin time automatically. The
+ * trace sampling decision of the other message is inherited as well (see
+ * smx_msg_create_from()).
+ *
+ * @param msg
+ *  A pointer to the derived message.
+ * @param parent
+ *  A pointer to the message the derived message originates from.
+ */
+void smx_msg_inherit_origin( smx_msg_t* msg, smx_msg_t* parent );
+
 /**
  * @brief Unpack the message payload
  *
@@ -189,6 +290,30 @@ void smx_msg_prevent_backup( smx_msg_t* msg );
  */
 void* smx_msg_unpack( smx_msg_t* msg );
 
+/**
+ * Set the partition key of a message. If a message is sent to a partitioned
+ * group of net replicas (see the net configuration option `partitioned`) all
+ * messages with the same key are processed by the same replica. The key is
+ * preserved when the message is copied.
+ *
+ * @param msg
+ *  A pointer to the message where the key will be set.
+ * @param key
+ *  An arbitrary integer identifying the partition.
+ */
+void smx_msg_set_partition_key( smx_msg_t* msg, uint64_t key );
+
+/**
+ * Set the partition key of a message from a string. The string is hashed and
+ * the result is used as partition key (see smx_msg_set_partition_key()).
+ *
+ * @param msg
+ *  A pointer to the message where the key will be set.
+ * @param key
+ *  An arbitrary string identifying the partition.
+ */
+void smx_msg_set_partition_key_str( smx_msg_t* msg, const char* key );
+
 /**
  * Set the type of the message payload. The type can be an arbitrary string.
  *
@@ -17,6 +17,12 @@
 #ifndef SMXNET_H
 #define SMXNET_H
 
+/**
+ * The number of configuration levels of a net: the net id, the net name, the
+ * box implementation, and all nets.
+ */
+#define SMX_NET_CONF_LEVELS 4
+
 /**
  * @def SMX_LOG()
  *
@@ -173,6 +179,33 @@
     ( ( h == NULL ) ? 0 : ( ( ( smx_net_t* )h )->count == 1 ? 1 : 0 ) )
 
 
+/**
+ * Allocate a net structure and initialise all fields with default values.
+ * The net configuration is not read and the net is not counted in the RTS.
+ * Use smx_net_create() to create a net from the app configuration.
+ *
+ * @param id        a unique net identifier
+ * @param name      the name of the net
+ * @param impl      the name of the box implementation
+ * @param cat_name  the name of the zlog category
+ * @param rts       a pointer to the main rts structure
+ * @param prio      the RT thread priority (0 means no rt thread)
+ * @return          a pointer to the allocated net or NULL
+ */
+smx_net_t* smx_net_alloc( unsigned int id, const char* name,
+        const char* impl, const char* cat_name, smx_rts_t* rts, int prio );
+
+/**
+ * Create a replica of a net. The replica uses the same box implementation,
+ * the same properties, and a copy of the static configuration of the original
+ * net. The port signature is allocated but no channels are connected.
+ *
+ * @param h     pointer to the net handler of the original net
+ * @param id    a unique net identifier for the replica
+ * @return      a pointer to the created replica or NULL
+ */
+smx_net_t* smx_net_clone( smx_net_t* h, unsigned int id );
+
 /**
  * Read from a collector of a net.
  *
@@ -186,6 +219,63 @@
 smx_msg_t* smx_net_collector_read( void* h, smx_collector_t* collector,
         smx_channel_t** in, int count_in, int* last_idx );
 
+/**
+ * Load a net config file through the config file cache. Each file is parsed
+ * only once and later loads of the same path return a copy of the cached
+ * document. The cache is not synchronised and must only be accessed by the
+ * main thread, i.e. while nets are created.
+ *
+ * @param cache     a pointer to the config file cache. If NULL, the file is
+ *                  parsed without caching.
+ * @param path      the path to the json file.
+ * @param error     an output parameter to store the error on failure.
+ * @return          a new document which must be freed by the caller or NULL
+ *                  on failure.
+ */
+bson_t* smx_net_conf_file_load( smx_hmap_t* cache, const char* path,
+        bson_error_t* error );
+
+/**
+ * Destroy a net config file cache and all cached documents.
+ *
+ * @param cache     a pointer to the cache. NULL is ignored.
+ */
+void smx_net_conf_files_destroy( smx_hmap_t* cache );
+
+/**
+ * Add a configuration level to the net configuration index. The document is
+ * not copied and must outlive the index. If the path is already indexed, the
+ * first occurence is kept.
+ *
+ * @param index     a pointer to the index.
+ * @param path      the path of the level relative to `_nets`, e.g.
+ *                  `impl.name._default`.
+ * @param iter      an iterator pointing to the level document. Other types
+ *                  are ignored.
+ * @return          0 on success or -1 on failure.
+ */
+int smx_net_conf_index_add( smx_hmap_t* index, const char* path,
+        bson_iter_t* iter );
+
+/**
+ * Create an index of the `_nets` key of the app configuration. The tree is
+ * parsed once and each configuration level (`_default`, `<impl>._default`,
+ * `<impl>.<name>._default`, and `<impl>.<name>.<id>`) is stored in a hash map
+ * by its path. The index refers to the app configuration which must not be
+ * modified or destroyed before the index.
+ *
+ * @param conf      a pointer to the app configuration.
+ * @return          a pointer to the index or NULL on failure.
+ */
+smx_hmap_t* smx_net_conf_index_create( bson_t* conf );
+
+/**
+ * Destroy a net configuration index.
+ *
+ * @param index     a pointer to the index. NULL is ignored.
+ */
+void smx_net_conf_index_destroy( smx_hmap_t* index );
+
 /**
  * Create a new net instance. This includes
  *  - creating a zlog category
@@ -204,7 +294,24 @@ smx_net_t* smx_net_create( unsigned int id, const char* name,
         const char* impl, const char* cat_name, smx_rts_t* rts, int prio );
 
 /**
- * Destroy a net
+ * Create a net of a built-in box implementation (e.g. a dispatcher) which is
+ * not part of the generated network. The next free net id is used, the port
+ * signature is allocated, and the net is registered in the RTS. If no
+ * configuration is available an empty configuration is assigned.
+ *
+ * @param rts       a pointer to the main rts structure
+ * @param impl      the name of the box implementation (used as net name)
+ * @param prio      the RT thread priority (0 means no rt thread)
+ * @param indegree  number of input ports
+ * @param outdegree number of output ports
+ * @return          a pointer to the created net or NULL
+ */
+smx_net_t* smx_net_create_internal( smx_rts_t* rts, const char* impl,
+        int prio, int indegree, int outdegree );
+
+/**
+ * Destroy a net. This includes all replicas of the net with their dispatchers,
+ * mergers, and channels (see smx_net_group_create()).
  *
  * @param h         pointer to the net handler
  */
@@ -213,65 +320,90 @@ void smx_net_destroy( smx_net_t* h );
 /**
  * Get a boolean property configuration setting for the current net.
  *
- * The function hiearchically searches for a confic that is specific for
+ * The function hiearchically searches the configuration levels of the net
+ * (see smx_net_get_conf_levels()) for a property that is specific for
  *  1. this net id
  *  2. this net name
  *  3. the box implementation of this net
  *  4. all nets
  *
- *  If a hit is found, the function returns te config and does not continue
- *  searching.
+ *  If a hit of the correct type is found, the function returns the config and
+ *  does not continue searching.
+ *
+ * @param levels
+ *  The #SMX_NET_CONF_LEVELS configuration levels of the net.
+ * @param prop
+ *  The name of the property.
  *
- * @param conf
- *  The input buffer of the app configuration
+ * @return
+ *  the boolean property or false if nothing was found
+ */
+bool smx_net_get_boolean_prop( bson_t** levels, const char* prop );
+
+/**
+ * Get the configuration levels of a net from the net configuration index.
+ * The levels are ordered from the most to the least specific, i.e. the net
+ * id, the net name, the box implementation, and all nets. Missing levels are
+ * set to NULL.
+ *
+ * @param index
+ *  A pointer to the net configuration index (see
+ *  smx_net_conf_index_create()). If NULL, all levels are set to NULL.
  * @param name
  *  The name of the net
  * @param impl
  *  The box implemntation name
  * @param id
  *  The id of the net
- * @param prop
- *  The name of the property.
+ * @param levels
+ *  An array of #SMX_NET_CONF_LEVELS document pointers to fill.
+ */
+void smx_net_get_conf_levels( smx_hmap_t* index, const char* name,
+        const char* impl, unsigned int id, bson_t** levels );
+
+/**
+ * Get a percentile of the execution time of the box implementation. The
+ * execution time is recorded for every call of the box implementation and
+ * includes the time the net is blocked on channels. This can be called at
+ * any time by any thread.
  *
+ * @param h
+ *  A pointer to the net handler.
+ * @param percentile
+ *  The percentile in the range [0, 100], e.g. 99.9.
  * @return
- *  the boolean property
+ *  The execution time in nanoseconds or 0 if nothing was recorded yet.
  */
-bool smx_net_get_boolean_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop );
+uint64_t smx_net_get_impl_time( smx_net_t* h, double percentile );
 
 /**
  * Get a int property configuration setting for the current net.
  *
- * The function hiearchically searches for a confic that is specific for
+ * The function hiearchically searches the configuration levels of the net
+ * (see smx_net_get_conf_levels()) for a property that is specific for
  *  1. this net id
  *  2. this net name
  *  3. the box implementation of this net
  *  4. all nets
  *
- *  If a hit is found, the function returns te config and does not continue
- *  searching.
+ *  If a hit of the correct type is found, the function returns the config and
+ *  does not continue searching.
  *
- * @param conf
- *  The input buffer of the app configuration
- * @param name
- *  The name of the net
- * @param impl
- *  The box implemntation name
- * @param id
- *  The id of the net
+ * @param levels
+ *  The #SMX_NET_CONF_LEVELS configuration levels of the net.
  * @param prop
  *  The name of the property.
  *
  * @return
- *  the boolean property
+ *  the int property or 0 if nothing was found
  */
-int smx_net_get_int_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop );
+int smx_net_get_int_prop( bson_t** levels, const char* prop );
 
 /**
  * Get the appropriate json configuration for the current net.
  *
- * The function hiearchically searches for a confic that is specific for
+ * The function hiearchically searches the configuration levels of the net
+ * (see smx_net_get_conf_levels()) for a `config` item that is specific for
  *  1. this net id
  *  2. this net name
  *  3. the box implementation of this net
@@ -282,64 +414,162 @@ int smx_net_get_int_prop( bson_t* conf, const char* name, const char* impl,
  *
  * @param h
  *  pointer to the net handler
- * @param conf
- *  The input buffer of the app configuration
- * @param name
- *  The name of the net
- * @param impl
- *  The box implemntation name
- * @param id
- *  The id of the net
+ * @param levels
+ *  The #SMX_NET_CONF_LEVELS configuration levels of the net.
  *
  * @return
  *  0 on success, -1 if nothing was found.
  */
-int smx_net_get_json_doc( smx_net_t* h, bson_t* conf, const char* name,
-        const char* impl, unsigned int id );
+int smx_net_get_json_doc( smx_net_t* h, bson_t** levels );
 
 /**
- * Get the json configuration for a given search string.
+ * Load the json configuration of a `config` item. The item is either a
+ * document or the path to a json file.
  *
  * @param h
  *  pointer to the net handler
- * @param conf
- *  The input buffer of the app configuration
- * @param search_str
- *  The hierachical search string
+ * @param item
+ *  An iterator pointing to the `config` item
+ * @param level
+ *  A description of the configuration level of the item, used for logging
  * @return
  *  0 on success, -1 if nothing was found.
  */
-int smx_net_get_json_doc_item( smx_net_t* h, bson_t* conf,
-        const char* search_str );
+int smx_net_get_json_doc_item( smx_net_t* h, bson_iter_t* item,
+        const char* level );
+
+/**
+ * Get a percentile of the net loop period. The loop period is the time
+ * between the start of two consecutive calls of the box implementation and
+ * includes the state update and all blocking. This can be called at any time
+ * by any thread.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ * @param percentile
+ *  The percentile in the range [0, 100], e.g. 99.9.
+ * @return
+ *  The loop period in nanoseconds or 0 if nothing was recorded yet.
+ */
+uint64_t smx_net_get_loop_time( smx_net_t* h, double percentile );
+
+/**
+ * Find a property of a given type in the configuration levels of a net. The
+ * levels are searched from the most to the least specific, values of other
+ * types are skipped.
+ *
+ * @param levels
+ *  The #SMX_NET_CONF_LEVELS configuration levels of the net.
+ * @param prop
+ *  The name of the property.
+ * @param type
+ *  The required BSON type of the property.
+ * @param iter
+ *  An iterator which points to the property on success.
+ *
+ * @return
+ *  true if the property was found, false otherwise.
+ */
+bool smx_net_get_prop( bson_t** levels, const char* prop, bson_type_t type,
+        bson_iter_t* iter );
 
 /**
  * Get a string property configuration setting for the current net.
  *
- * The function hiearchically searches for a confic that is specific for
+ * The function hiearchically searches the configuration levels of the net
+ * (see smx_net_get_conf_levels()) for a property that is specific for
  *  1. this net id
  *  2. this net name
  *  3. the box implementation of this net
  *  4. all nets
  *
- *  If a hit is found, the function returns te config and does not continue
- *  searching.
+ *  If a hit of the correct type is found, the function returns the config and
+ *  does not continue searching.
  *
- * @param conf
- *  The input buffer of the app configuration
- * @param name
- *  The name of the net
- * @param impl
- *  The box implemntation name
- * @param id
- *  The id of the net
+ * @param levels
+ *  The #SMX_NET_CONF_LEVELS configuration levels of the net.
  * @param prop
  *  The name of the property.
  *
  * @return
- *  the string property
+ *  the string property or NULL if nothing was found
+ */
+const char* smx_net_get_string_prop( bson_t** levels, const char* prop );
+
+/**
+ * Replicate a net according to the configuration property `replicas`. This
+ * must be called after all channels are connected and before the
+ * initialisation barriers are set up (see smx_program_init_run()).
+ *
+ * The net is cloned `replicas - 1` times. Each connected input channel is
+ * read by a dispatcher net which distributes the messages in a round-robin
+ * manner among the replicas and each connected output channel is written by
+ * a merger net which collects the messages from the replicas in the same
+ * order. Each replica runs in its own thread and allocates its own state
+ * through the init function of the box implementation.
+ *
+ * If the configuration property `partitioned` is set, the dispatchers route
+ * each message to the replica selected by its partition key (see
+ * smx_msg_set_partition_key()) and the outputs of the replicas are merged by
+ * routing nodes in the order the messages become available.
+ *
+ * Only nets with blocking channels can be replicated. Routing nodes, temporal
+ * firewalls, and nets with a dynamic configuration port are not supported.
+ *
+ * If the replication fails, the partial replication is undone and the net is
+ * connected to its original channels again.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ * @return
+ *  0 on success or if no replication is configured, -1 on failure.
+ */
+int smx_net_group_create( smx_net_t* h );
+
+/**
+ * Destroy all replicas, dispatchers, mergers, and channels created by
+ * smx_net_group_create(). This is called by smx_net_destroy().
+ *
+ * @param h
+ *  A pointer to the net handler of the original net.
+ */
+void smx_net_group_destroy( smx_net_t* h );
+
+/**
+ * Reconnect the original net of a replication group to the channels which
+ * were taken over by the dispatchers and mergers of the group. This must be
+ * called before smx_net_group_destroy() to undo a failed replication.
+ *
+ * @param h
+ *  A pointer to the net handler of the original net.
+ */
+void smx_net_group_restore_ports( smx_net_t* h );
+
+/**
+ * Start the threads of all replicas, dispatchers, and mergers of a net. This
+ * is called by smx_net_run().
+ *
+ * @param ths
+ *  The target array to store the thread ids. The net ids serve as index.
+ * @param h
+ *  A pointer to the net handler of the original net.
+ * @param box_impl( arg )
+ *  The start routine of the box implementation of the original net.
+ * @return
+ *  0 on success, -1 on failure
+ */
+int smx_net_group_run( pthread_t* ths, smx_net_t* h,
+        void* box_impl( void* arg ) );
+
+/**
+ * Wait for all replicas, dispatchers, and mergers of a net to terminate.
+ *
+ * @param ths
+ *  The array holding the thread ids. The net ids serve as index.
+ * @param h
+ *  A pointer to the net handler of the original net.
  */
-const char* smx_net_get_string_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop );
+void smx_net_group_wait_end( pthread_t* ths, smx_net_t* h );
 
 /**
  * Initialise a net
@@ -350,6 +580,29 @@ const char* smx_net_get_string_prop( bson_t* conf, const char* name, const char*
  */
 void smx_net_init( smx_net_t* h, int indegree, int outdegree );
 
+/**
+ * Enable the histograms of all input channels of a net as configured with
+ * the net properties `latency_hist` (see smx_channel_set_latency_hist()) and
+ * `queue_hist` (see smx_channel_set_queue_hist()). This must be called after
+ * the net was connected to its channels.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ */
+void smx_net_init_channel_hists( smx_net_t* h );
+
+/**
+ * Apply the wakeup moderation configured with the net properties
+ * `wake_threshold` and `wake_delay_us` to all input channels of a net (see
+ * smx_channel_set_wake_moderation()). Input channels on which moderation has
+ * no effect are skipped. This must be called after the net was connected to
+ * its channels.
+ *
+ * @param h
+ *  A pointer to the net handler.
+ */
+void smx_net_init_wake_moderation( smx_net_t* h );
+
 /**
  * Logs a warning if the net rate is lower or higher that the expected net rate
  * by 20%.
@@ -362,6 +615,9 @@ void smx_net_report_rate_warning( smx_net_t* h );
 /**
  * @brief create pthred of net
  *
+ * If the net is replicated, the threads of all replicas, dispatchers, and
+ * mergers are created as well.
+ *
  * @param ths               the target array to store the thread id
  * @param idx               the index of where to store the thread id in the
  *                          target array
@@ -371,6 +627,16 @@ void smx_net_report_rate_warning( smx_net_t* h );
  */
 int smx_net_run( pthread_t* ths, int idx, void* box_impl( void* arg ), void* h );
 
+/**
+ * Replace the configuration of a net. All config handles of the net (see
+ * smx_config_handle_create()) are invalidated and resolve their value again
+ * on the next read.
+ *
+ * @param h     pointer to the net handler
+ * @param conf  pointer to the new configuration
+ */
+void smx_net_set_conf( smx_net_t* h, bson_t* conf );
+
 /**
  * @brief the start routine of a thread associated to a box
  *
@@ -7,13 +7,128 @@
  *  You can obtain one at https://mozilla.org/MPL/2.0/.
  *
  * Profiler definitions for the runtime system library of Streamix
+ *
+ * Profiler events are grouped into event classes. Each net holds a bitmask of
+ * enabled classes which is initialised with the net property `profiler_mask`
+ * (all classes if omitted, none if set to 0) and can be changed at runtime
+ * with smx_profiler_set_mask(), e.g. by a box reacting to a control channel.
+ * Sending #SMX_PROFILER_SIGNAL to the process pauses or resumes the profiling
+ * of all nets.
+ *
+ * Event classes which are not part of #SMX_PROFILER_MASK are compiled out of
+ * the hot path. E.g. to only keep deadline and time-triggered interval misses
+ * compile with `-DSMX_PROFILER_MASK=SMX_PROFILER_CLASS_CH_MISS`.
  */
 
+#include <signal.h>
 #include "smxtypes.h"
 
 #ifndef SMXPROFILER_H
 #define SMXPROFILER_H
 
+/** channel read and write events */
+#define SMX_PROFILER_CLASS_CH_RW        0x01
+/** blocking channel read and write events */
+#define SMX_PROFILER_CLASS_CH_BLOCK     0x02
+/** message overwrite, dismiss, and duplication events */
+#define SMX_PROFILER_CLASS_CH_LOSS      0x04
+/** deadline and time-triggered interval miss events */
+#define SMX_PROFILER_CLASS_CH_MISS      0x08
+/** message create, copy, and destroy events */
+#define SMX_PROFILER_CLASS_MSG          0x10
+/** net loop and box implementation events */
+#define SMX_PROFILER_CLASS_NET          0x20
+/** all event classes */
+#define SMX_PROFILER_CLASS_ALL          0x3f
+
+#ifndef SMX_PROFILER_MASK
+/** The event classes which are compiled into the library */
+#define SMX_PROFILER_MASK SMX_PROFILER_CLASS_ALL
+#endif
+
+/** The signal to pause or resume the profiler of all nets */
+#define SMX_PROFILER_SIGNAL SIGUSR2
+
+/**
+ * @def SMX_PROFILER_CH_CLASS()
+ *
+ * Get the event class of a channel action. This is a constant expression if
+ * the action is constant.
+ */
+#define SMX_PROFILER_CH_CLASS( action )\
+    ( ( ( action ) == SMX_PROFILER_ACTION_CH_READ\
+            || ( action ) == SMX_PROFILER_ACTION_CH_READ_COLLECTOR\
+            || ( action ) == SMX_PROFILER_ACTION_CH_WRITE\
+            || ( action ) == SMX_PROFILER_ACTION_CH_WRITE_COLLECTOR )\
+        ? SMX_PROFILER_CLASS_CH_RW\
+    : ( ( action ) == SMX_PROFILER_ACTION_CH_READ_BLOCK\
+            || ( action ) == SMX_PROFILER_ACTION_CH_READ_COLLECTOR_BLOCK\
+            || ( action ) == SMX_PROFILER_ACTION_CH_WRITE_BLOCK )\
+        ? SMX_PROFILER_CLASS_CH_BLOCK\
+    : ( ( action ) == SMX_PROFILER_ACTION_CH_OVERWRITE\
+            || ( action ) == SMX_PROFILER_ACTION_CH_DISMISS\
+            || ( action ) == SMX_PROFILER_ACTION_CH_DUPLICATE )\
+        ? SMX_PROFILER_CLASS_CH_LOSS\
+    : SMX_PROFILER_CLASS_CH_MISS )
+
+/**
+ * @def SMX_PROFILER_LOG_CH()
+ *
+ * Log a profiler event related to a channel. The call is compiled out if the
+ * class of the action is not part of #SMX_PROFILER_MASK. For details refer to
+ * smx_profiler_log_ch().
+ */
+#define SMX_PROFILER_LOG_CH( net, ch, msg, action, val ) do {\
+    if( SMX_PROFILER_MASK & SMX_PROFILER_CH_CLASS( action ) )\
+        smx_profiler_log_ch( net, ch, msg, action, val ); } while( 0 )
+
+/**
+ * @def SMX_PROFILER_LOG_MSG()
+ *
+ * Log a profiler event related to a message. The call is compiled out if
+ * #SMX_PROFILER_CLASS_MSG is not part of #SMX_PROFILER_MASK. For details refer
+ * to smx_profiler_log_msg().
+ */
+#define SMX_PROFILER_LOG_MSG( net, msg, action ) do {\
+    if( SMX_PROFILER_MASK & SMX_PROFILER_CLASS_MSG )\
+        smx_profiler_log_msg( net, msg, action ); } while( 0 )
+
+/**
+ * @def SMX_PROFILER_LOG_NET()
+ *
+ * Log a profiler event related to a net. The call is compiled out if
+ * #SMX_PROFILER_CLASS_NET is not part of #SMX_PROFILER_MASK. For details refer
+ * to smx_profiler_log_net().
+ */
+#define SMX_PROFILER_LOG_NET( net, action ) do {\
+    if( SMX_PROFILER_MASK & SMX_PROFILER_CLASS_NET )\
+        smx_profiler_log_net( net, action ); } while( 0 )
+
+/**
+ * @def SMX_PROFILER_SET_MASK()
+ *
+ * Set the enabled profiler event classes of the net. For details refer to
+ * smx_profiler_set_mask().
+ */
+#define SMX_PROFILER_SET_MASK( h, mask ) smx_profiler_set_mask( h, mask )
+
+/**
+ * Get the enabled profiler event classes of a net.
+ *
+ * @param net       a pointer to the net handler.
+ * @return          the bitmask of enabled event classes or 0 if the profiler
+ *                  of the net is disabled or paused.
+ */
+unsigned int smx_profiler_get_mask( smx_net_t* net );
+
+/**
+ * Install the handler of #SMX_PROFILER_SIGNAL if the profiler is enabled in
+ * any net.
+ *
+ * @param rts       a pointer to the RTS structure.
+ */
+void smx_profiler_init_signal( smx_rts_t* rts );
+
 /**
  * The function to log profiler messages related to a channel.
  *
@@ -44,4 +159,25 @@ void smx_profiler_log_msg( smx_net_t* net, smx_msg_t* msg,
  */
 void smx_profiler_log_net( smx_net_t* net, smx_profiler_action_net_t action );
 
+/**
+ * Set the enabled profiler event classes of a net. This can be called from any
+ * thread. Nets with a disabled profiler (see net property `profiler`) are not
+ * affected.
+ *
+ * @param net       a pointer to the net handler.
+ * @param mask      the bitmask of enabled event classes, e.g.
+ *                  `SMX_PROFILER_CLASS_CH_MISS | SMX_PROFILER_CLASS_NET`.
+ *                  Bits outside of #SMX_PROFILER_CLASS_ALL are ignored and 0
+ *                  disables all classes.
+ */
+void smx_profiler_set_mask( void* net, unsigned int mask );
+
+/**
+ * The handler of #SMX_PROFILER_SIGNAL. Each call pauses or resumes the
+ * profiler of all nets.
+ *
+ * @param sig       the signal number.
+ */
+void smx_profiler_signal_handler( int sig );
+
 #endif /* SMXPROFILER_H */
@@ -12,21 +12,52 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <zlog.h>
+#include "box_smx_dispatch.h"
+#include "box_smx_merge.h"
 #include "box_smx_rn.h"
 #include "box_smx_tf.h"
 #include "smxch.h"
 #include "smxconfig.h"
+#include "smxhist.h"
 #include "smxlog.h"
+#include "smxmetrics.h"
 #include "smxmsg.h"
 #include "smxnet.h"
 #include "smxprofiler.h"
 #include "smxtest.h"
+#include "smxtracer.h"
 #include "smxtypes.h"
 #include "smxutils.h"
 
 #ifndef SMXRTS_H
 #define SMXRTS_H
 
+/**
+ * The environment variable holding the path of the config snapshot. If set,
+ * the mapped app configuration is loaded from the snapshot if its inputs are
+ * unchanged, otherwise the snapshot is (re)written after the configuration
+ * was parsed and mapped (see smx_program_init()).
+ */
+#define SMX_SNAPSHOT_ENV "SMX_CONFIG_SNAPSHOT"
+/** The magic string at the start of a config snapshot */
+#define SMX_SNAPSHOT_MAGIC "SMXSNAPS"
+/** The version of the config snapshot layout */
+#define SMX_SNAPSHOT_VERSION 1
+
+typedef struct smx_snapshot_header_s smx_snapshot_header_t;
+
+/**
+ * The header of a config snapshot file. The header is followed by the BSON
+ * document of the mapped app configuration.
+ */
+struct smx_snapshot_header_s
+{
+    char        magic[8];       /**< #SMX_SNAPSHOT_MAGIC without termination */
+    uint32_t    version;        /**< #SMX_SNAPSHOT_VERSION */
+    uint32_t    size;           /**< the size of the BSON document in bytes */
+    uint64_t    hash;           /**< the hash of all configuration inputs */
+};
+
 // RTS MACROS ------------------------------------------------------------------
 
 /**
@@ -145,10 +176,13 @@
     smx_net_run( rts->ths, id, start_routine_ ## box_name, rts->nets[id] )
 
 /**
- * Macro to wait for all threads to reach this point.
+ * Macro to wait for all threads to reach this point. This includes the threads
+ * of net replicas.
  */
-#define SMX_NET_WAIT_END( id )\
-    smx_net_wait_end( rts->ths[id] )
+#define SMX_NET_WAIT_END( id ) do {\
+    smx_net_wait_end( rts->ths[id] );\
+    smx_net_group_wait_end( rts->ths, rts->nets[id] );\
+} while( 0 )
 
 /**
  * Macro to wait for cleanup of all nets to complete before running the
@@ -193,6 +227,12 @@ void smx_program_cleanup( smx_rts_t* rts );
  * Initialize the rts structure, read the configuration files, and initialize
  * the log.
  *
+ * If the environment variable #SMX_SNAPSHOT_ENV is set to a path, the mapped
+ * app configuration is loaded from this config snapshot as long as the
+ * library version, the app configuration file, and the config map files are
+ * unchanged. Otherwise the files are parsed and mapped and the snapshot is
+ * written for the next start.
+ *
  * @param app_conf
  *  The path of the application config file to be loaded.
  * @param log_conf
@@ -266,9 +306,93 @@ int smx_program_init_conf( const char* conf, bson_t* doc, char** name );
 int smx_program_init_maps( const char* path, bson_t* doc, bson_iter_t* i_maps,
         bson_t* payload );
 
+/**
+ * Compute the hash of all inputs of the mapped app configuration, i.e. the
+ * library version and the path and content of the app configuration file and
+ * of each config map file.
+ *
+ * @param app_conf
+ *  The path of the application config file.
+ * @param app_conf_maps
+ *  The path list of the config map files.
+ * @param app_conf_map_count
+ *  The number of config map files.
+ * @param hash
+ *  An output parameter where the hash will be stored.
+ * @return
+ *  0 on success, -1 on failure
+ */
+int smx_program_init_snapshot_hash( const char* app_conf,
+        const char** app_conf_maps, int app_conf_map_count, uint64_t* hash );
+
+/**
+ * Add the path and the content of a file to an input hash of a config
+ * snapshot.
+ *
+ * @param path
+ *  The path of the file.
+ * @param hash
+ *  A pointer to the hash to be updated.
+ * @return
+ *  0 on success, -1 on failure
+ */
+int smx_program_init_snapshot_hash_file( const char* path, uint64_t* hash );
+
+/**
+ * Memory-map a config snapshot and copy the mapped app configuration if the
+ * snapshot is valid and matches the input hash.
+ *
+ * @param path
+ *  The path of the snapshot file.
+ * @param hash
+ *  The hash of the configuration inputs (see
+ *  smx_program_init_snapshot_hash()).
+ * @param doc
+ *  An initialised bson document where the configuration data will be stored.
+ * @param name
+ *  A pointer to a location where the name pointer of the app will be stored.
+ * @return
+ *  0 on success, -1 if the snapshot is missing, invalid, or outdated.
+ */
+int smx_program_init_snapshot_load( const char* path, uint64_t hash,
+        bson_t* doc, char** name );
+
+/**
+ * Write the mapped app configuration to a config snapshot. The snapshot is
+ * written to a temporary file which is then renamed to the snapshot path.
+ *
+ * @param path
+ *  The path of the snapshot file.
+ * @param hash
+ *  The hash of the configuration inputs (see
+ *  smx_program_init_snapshot_hash()).
+ * @param doc
+ *  The mapped app configuration.
+ * @return
+ *  0 on success, -1 on failure
+ */
+int smx_program_init_snapshot_write( const char* path, uint64_t hash,
+        bson_t* doc );
+
+/**
+ * Select the mutex protocol of all channels, collectors, the net mutex, and
+ * the log mutex depending on the connected nets. Mutexes which can be
+ * accessed by a TT net (a net with a priority > 0) use priority inheritance,
+ * all other mutexes are adaptive. This must be called after all nets are
+ * connected and before the net threads are started.
+ *
+ * @param rts
+ *  A pointer to the RTS structure which holds the network information.
+ */
+void smx_program_init_mutex( smx_rts_t* rts );
+
 /**
  * Initialize the synchronisation barrier to make sure all nets finish
- * intialisation befor staring the main loop.
+ * intialisation befor staring the main loop. Before the barriers are set up,
+ * nets with the configuration property `replicas` are replicated (see
+ * smx_net_group_create()) and the mutex protocols are selected (see
+ * smx_program_init_mutex()). If a net cannot be replicated or if the
+ * configured tracer or metrics cannot be started, the program is terminated.
  *
  * @param rts
  *  A pointer to the RTS structure which holds the network information.
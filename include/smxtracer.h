@@ -0,0 +1,293 @@
+/**
+ * @file    smxtracer.h
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Built-in binary tracer for the runtime system library of Streamix
+ *
+ * The tracer is an alternative to the LTTng tracepoints of the profiler. It
+ * is enabled with the top-level key `_tracer` of the app configuration:
+ *
+ * ```
+ * "_tracer": {
+ *     "path": "/tmp/app.smxtrace",
+ *     "ring_size": 4096,
+ *     "flush_interval_ms": 10,
+ *     "chrome_path": "/tmp/app.json"
+ * }
+ * ```
+ *
+ * Each net with an enabled profiler gets its own single-producer
+ * single-consumer ring buffer of fixed-size event records. The net thread is
+ * the only producer and never blocks: if the ring is full the event is
+ * dropped and counted. A background thread periodically moves the events of
+ * all rings to a memory-mapped trace file.
+ *
+ * The trace file consists of a header (::smx_tracer_header_s) followed by
+ * `event_count` records (::smx_tracer_event_s) in the byte order of the host.
+ * Within one net the records are ordered by time, records of different nets
+ * are interleaved in flush order.
+ *
+ * If `chrome_path` is set, the trace is converted to the Chrome Trace Event
+ * format at shutdown (see smx_tracer_export_chrome()). The resulting file can
+ * be inspected with `chrome://tracing` or the Perfetto UI.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "smxtypes.h"
+
+#ifndef SMXTRACER_H
+#define SMXTRACER_H
+
+/** The magic string at the start of a trace file */
+#define SMX_TRACER_MAGIC "SMXTRACE"
+/** The version of the trace file format */
+#define SMX_TRACER_VERSION 1
+/** The default number of event records per ring buffer */
+#define SMX_TRACER_RING_SIZE 4096
+/** The default flush interval of the background thread in milliseconds */
+#define SMX_TRACER_FLUSH_INTERVAL_MS 10
+/** The number of event records the trace file grows by */
+#define SMX_TRACER_FILE_CHUNK 65536
+
+typedef enum smx_tracer_event_type_e smx_tracer_event_type_t;
+typedef struct smx_tracer_event_s smx_tracer_event_t;
+typedef struct smx_tracer_header_s smx_tracer_header_t;
+
+/**
+ * The event classes of the tracer. The action of an event is a value of the
+ * corresponding profiler action enumeration.
+ */
+enum smx_tracer_event_type_e
+{
+    SMX_TRACER_EVENT_CH,    /**< a #smx_profiler_action_ch_e event */
+    SMX_TRACER_EVENT_MSG,   /**< a #smx_profiler_action_msg_e event */
+    SMX_TRACER_EVENT_NET    /**< a #smx_profiler_action_net_e event */
+};
+
+/**
+ * A binary event record of 32 bytes.
+ */
+struct smx_tracer_event_s
+{
+    uint64_t    ts;         /**< CLOCK_MONOTONIC timestamp in nanoseconds */
+    int64_t     msg_id;     /**< the message id or -1 */
+    int32_t     net_id;     /**< the id of the net logging the event */
+    int32_t     ch_id;      /**< the channel id or -1 */
+    int32_t     val;        /**< the channel count or 0 */
+    uint8_t     type;       /**< #smx_tracer_event_type_e */
+    uint8_t     action;     /**< the profiler action */
+    uint16_t    reserved;   /**< unused, always 0 */
+};
+
+/**
+ * The header of a trace file (64 bytes).
+ */
+struct smx_tracer_header_s
+{
+    char        magic[8];       /**< #SMX_TRACER_MAGIC without termination */
+    uint32_t    version;        /**< #SMX_TRACER_VERSION */
+    uint32_t    event_size;     /**< the size of an event record in bytes */
+    uint64_t    event_count;    /**< the number of event records */
+    uint64_t    drop_count;     /**< the number of dropped events */
+    uint64_t    start_ts;       /**< CLOCK_MONOTONIC start time in ns */
+    uint64_t    start_real_ts;  /**< CLOCK_REALTIME start time in ns */
+    uint64_t    reserved[2];    /**< unused, always 0 */
+};
+
+/**
+ * A single-producer single-consumer ring of event records. The producer only
+ * writes `head`, the consumer only writes `tail`.
+ */
+struct smx_tracer_ring_s
+{
+    uint64_t            head __attribute__(( aligned( 64 ) ));
+    uint64_t            tail __attribute__(( aligned( 64 ) ));
+    uint64_t            drop_count; /**< events dropped by the producer */
+    uint64_t            mask;       /**< the ring size minus one */
+    int                 net_id;     /**< the id of the producing net */
+    smx_tracer_event_t* events;     /**< the event records */
+};
+
+/**
+ * The tracer structure.
+ */
+struct smx_tracer_s
+{
+    char*                   path;       /**< the path of the trace file */
+    int                     fd;         /**< the file descriptor */
+    uint8_t*                map;        /**< the mapped trace file */
+    size_t                  capacity;   /**< the number of mappable events */
+    int                     ring_size;  /**< the number of records per ring */
+    int                     ring_count; /**< the number of rings */
+    smx_tracer_ring_t**     rings;      /**< the rings of all traced nets */
+    int                     flush_interval_ms; /**< the flush interval */
+    bool                    is_running; /**< is the flush thread running? */
+    pthread_t               th;         /**< the flush thread */
+    char*                   chrome_path; /**< the Chrome export path or NULL */
+    int                     net_count;  /**< the number of net names */
+    char**                  net_names;  /**< the net names, indexed by id */
+    int                     ch_count;   /**< the number of channel names */
+    char**                  ch_names;   /**< the channel names, indexed by id */
+};
+
+/**
+ * Create a tracer from the `_tracer` key of the app configuration. The trace
+ * file is created and mapped.
+ *
+ * @param conf
+ *  A pointer to the app configuration.
+ * @return
+ *  A pointer to the tracer or NULL if the tracer is disabled or the trace
+ *  file could not be created.
+ */
+smx_tracer_t* smx_tracer_create( bson_t* conf );
+
+/**
+ * Stop the flush thread, flush all remaining events, truncate the trace file
+ * to its final size and destroy the tracer.
+ *
+ * @param tracer
+ *  A pointer to the tracer. NULL is ignored.
+ */
+void smx_tracer_destroy( smx_tracer_t* tracer );
+
+/**
+ * Get the name of a profiler action as used by the LTTng tracepoints.
+ *
+ * @param type
+ *  The event class.
+ * @param action
+ *  The profiler action of the event class.
+ * @return
+ *  The name of the action.
+ */
+const char* smx_tracer_action_str( smx_tracer_event_type_t type, int action );
+
+/**
+ * Convert the events of the trace file to the Chrome Trace Event format
+ * (JSON). Each net is a track (thread) showing
+ *  - a slice for each net loop and each call of the box implementation,
+ *  - a slice for each time period the net was blocked on a channel,
+ *  - a slice for each message copy, and
+ *  - an instant event for all other channel and message events.
+ *
+ * Additionally, a counter track shows the fill level of each channel.
+ *
+ * This must be called after all events were flushed.
+ *
+ * @param tracer
+ *  A pointer to the tracer.
+ * @param path
+ *  The path of the JSON file to write.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_tracer_export_chrome( smx_tracer_t* tracer, const char* path );
+
+/**
+ * Write a JSON string with escaped quotes, backslashes, and control
+ * characters.
+ *
+ * @param f
+ *  The file to write to.
+ * @param str
+ *  The string to write. NULL is written as empty string.
+ */
+void smx_tracer_export_str( FILE* f, const char* str );
+
+/**
+ * Move all pending events of all rings to the trace file. This must only be
+ * called by one thread at a time.
+ *
+ * @param tracer
+ *  A pointer to the tracer.
+ * @return
+ *  The number of moved events or -1 on failure.
+ */
+int smx_tracer_flush( smx_tracer_t* tracer );
+
+/**
+ * Grow the trace file and its mapping such that at least `count` event
+ * records fit.
+ *
+ * @param tracer
+ *  A pointer to the tracer.
+ * @param count
+ *  The number of event records that must fit into the file.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_tracer_grow( smx_tracer_t* tracer, size_t count );
+
+/**
+ * Create a ring buffer.
+ *
+ * @param size
+ *  The number of event records. This is rounded up to a power of two.
+ * @param net_id
+ *  The id of the producing net.
+ * @return
+ *  A pointer to the ring or NULL on failure.
+ */
+smx_tracer_ring_t* smx_tracer_ring_create( int size, int net_id );
+
+/**
+ * Destroy a ring buffer.
+ *
+ * @param ring
+ *  A pointer to the ring. NULL is ignored.
+ */
+void smx_tracer_ring_destroy( smx_tracer_ring_t* ring );
+
+/**
+ * The start routine of the flush thread.
+ *
+ * @param tracer
+ *  A pointer to the tracer.
+ * @return
+ *  This function always returns NULL.
+ */
+void* smx_tracer_run( void* tracer );
+
+/**
+ * Create a ring for each net with an enabled profiler, register the names of
+ * all nets and channels, and start the flush thread. This must be called
+ * after all nets were created and before the net threads are started.
+ *
+ * @param tracer
+ *  A pointer to the tracer. NULL is ignored.
+ * @param rts
+ *  A pointer to the RTS structure.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_tracer_start( smx_tracer_t* tracer, smx_rts_t* rts );
+
+/**
+ * Write an event record to a ring buffer. This is lock-free and never blocks.
+ * If the ring is full the event is dropped.
+ *
+ * @param ring
+ *  A pointer to the ring of the calling net. If NULL, nothing is done.
+ * @param type
+ *  The event class.
+ * @param action
+ *  The profiler action of the event class.
+ * @param net_id
+ *  The id of the net logging the event.
+ * @param ch_id
+ *  The channel id or -1.
+ * @param msg_id
+ *  The message id or -1.
+ * @param val
+ *  The channel count or 0.
+ */
+void smx_tracer_write( smx_tracer_ring_t* ring, smx_tracer_event_type_t type,
+        int action, int net_id, int ch_id, int64_t msg_id, int val );
+
+#endif /* SMXTRACER_H */
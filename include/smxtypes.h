@@ -17,7 +17,6 @@
 #ifndef SMXTYPES_H
 #define SMXTYPES_H
 
-#define SMX_CONFIG_MAX_MAP_ITEMS      1000
 #define SMX_MSG_RAW_TYPE 0
 #define SMX_MSG_RAW_TYPE_STR "raw"
 #define SMX_MSG_INT_TYPE 1
@@ -65,17 +64,28 @@ typedef struct smx_collector_s smx_collector_t;       /**< ::smx_collector_s */
 typedef struct smx_fifo_s smx_fifo_t;                 /**< ::smx_fifo_s */
 typedef struct smx_fifo_item_s smx_fifo_item_t;       /**< ::smx_fifo_item_s */
 typedef struct smx_guard_s smx_guard_t;               /**< ::smx_guard_s */
+typedef struct smx_hist_s smx_hist_t;                 /**< ::smx_hist_s */
+typedef struct smx_hmap_s smx_hmap_t;                 /**< ::smx_hmap_s */
+typedef struct smx_hmap_item_s smx_hmap_item_t;       /**< ::smx_hmap_item_s */
 /**
  * The streamix message type.
  * Refer to the structure definition for more information ::smx_msg_s.
  */
 typedef struct smx_msg_s smx_msg_t;
+typedef struct smx_metrics_s smx_metrics_t;           /**< ::smx_metrics_s */
+typedef struct smx_metrics_ch_s smx_metrics_ch_t;     /**< ::smx_metrics_ch_s */
+typedef struct smx_metrics_net_s smx_metrics_net_t;   /**< ::smx_metrics_net_s */
 typedef struct smx_net_s smx_net_t;                   /**< ::smx_net_s */
+typedef struct smx_net_group_s smx_net_group_t;       /**< ::smx_net_group_s */
 typedef struct smx_net_sig_s smx_net_sig_t;           /**< ::smx_net_sig_s */
+typedef struct smx_tracer_s smx_tracer_t;             /**< ::smx_tracer_s */
+typedef struct smx_tracer_ring_s smx_tracer_ring_t;   /**< ::smx_tracer_ring_s */
 /** ::smx_msg_tsmem_data_map_s */
 typedef struct smx_config_data_map_s smx_config_data_map_t;
 /** ::smx_msg_tsmem_data_maps_s */
 typedef struct smx_config_data_maps_s smx_config_data_maps_t;
+/** ::smx_config_handle_s */
+typedef struct smx_config_handle_s smx_config_handle_t;
 
 /**
  * The error state of a channel end
@@ -117,7 +127,8 @@ enum smx_channel_type_e
     SMX_FIFO,           /**< a simple FIFO */
     SMX_FIFO_D,         /**< a FIFO with decoupled output */
     SMX_D_FIFO,         /**< a FIFO with decoupled input */
-    SMX_D_FIFO_D        /**< a FIFO with decoupled input and output */
+    SMX_D_FIFO_D,       /**< a FIFO with decoupled input and output */
+    SMX_RENDEZVOUS      /**< a zero-length channel with direct hand-off */
 };
 
 /**
@@ -142,9 +153,10 @@ enum smx_config_map_error_e
     SMX_CONFIG_MAP_ERROR_MISSING_SRC_DEF = -296,
     SMX_CONFIG_MAP_ERROR_MISSING_TGT_KEY = -295,
     SMX_CONFIG_MAP_ERROR_MISSING_TGT_DEF = -294,
-    SMX_CONFIG_MAP_ERROR_MAP_COUNT_EXCEEDED = -293,
+    SMX_CONFIG_MAP_ERROR_MAP_COUNT_EXCEEDED = -293, /**< allocation failed */
     SMX_CONFIG_MAP_ERROR_NO_MAP_ITEM = -292,
     SMX_CONFIG_MAP_ERROR_BAD_TYPE_OPTION = -291,
+    SMX_CONFIG_MAP_ERROR_TGT_INDEX = -290, /**< index allocation failed */
 };
 
 /**
@@ -212,12 +224,18 @@ struct smx_channel_s
     smx_channel_type_t  type;       /**< type of the channel */
     char*               name;       /**< name of the channel */
     smx_fifo_t*         fifo;       /**< ::smx_fifo_s */
+    smx_msg_t*          handoff;    /**< message in transit (rendezvous) */
+    smx_hist_t*         latency_hist; /**< end-to-end latency at read or NULL */
+    smx_hist_t*         queue_hist; /**< queueing delay in the FIFO or NULL */
+    smx_metrics_ch_t*   metrics;    /**< the live metrics record or NULL */
     smx_guard_t*        guard;      /**< ::smx_guard_s */
     smx_collector_t*    collector;  /**< ::smx_collector_s, collect signals */
     smx_channel_end_t*  sink;       /**< ::smx_channel_end_s */
     smx_channel_end_t*  source;     /**< ::smx_channel_end_s */
     zlog_category_t*    cat;        /**< zlog category of a channel end */
+    int                 log_level;  /**< the lowest enabled level of `cat` */
     pthread_mutex_t     ch_mutex;   /**< mutual exclusion */
+    bool                is_prio_inherit; /**< does the mutex use PI? */
 };
 
 /**
@@ -237,6 +255,17 @@ struct smx_channel_end_s
     /** A pointer to the filter function. */
     bool ( *content_filter )( smx_net_t* net, smx_msg_t* msg );
     struct timespec     timeout;    /**< channel-blocking timeout */
+    /** wake a blocked consumer only once this many messages are queued */
+    int                 wake_threshold;
+    /** wake a blocked consumer at the latest after this many microseconds */
+    long                wake_delay_us;
+    struct timespec     wake_ts;    /**< wake deadline of a pending batch */
+    uint64_t            block_time; /**< total time blocked in ns */
+    uint64_t            block_max;  /**< longest blocking episode in ns */
+    unsigned long       block_count; /**< number of blocking episodes */
+    uint64_t            anomaly_ts; /**< time of the last anomaly log in ns */
+    unsigned long       anomaly_suppressed; /**< anomaly logs since then */
+    unsigned long       anomaly_suppressed_total; /**< all dropped logs */
 };
 
 /**
@@ -252,6 +281,7 @@ struct smx_collector_s
     int                 count;      /**< collection of channel counts */
     int                 ch_count;   /**< number of connected channels */
     smx_channel_state_t state;      /**< state of the channel */
+    bool                is_prio_inherit; /**< does the mutex use PI? */
 };
 
 /**
@@ -275,6 +305,13 @@ struct smx_config_data_map_s
      */
     bson_iter_t src_iter;
     bool is_src_iter_set;
+    /** The source payload used by the last application of the map */
+    bson_t* src_doc;
+    /** A copy of the source value of the last incremental application */
+    bson_value_t src_value;
+    bool is_src_value_set;   /**< Is `src_value` set? */
+    /** Did the source value change in the last incremental application? */
+    bool is_changed;
     const char* tgt_path;    /**< The target value location (use dot-notation) */
     bson_iter_t tgt_iter;    /**< The target value location iterator  */
     bson_t* src_payload;
@@ -293,13 +330,56 @@ struct smx_config_data_map_s
 struct smx_config_data_maps_s
 {
     void* h;
-    smx_config_data_map_t items[SMX_CONFIG_MAX_MAP_ITEMS];
-    int count;
+    smx_config_data_map_t* items; /**< The map items */
+    int count;               /**< The number of map items */
+    int size;                /**< The allocated number of map items */
     bool is_extended;
+    smx_hmap_t* tgt_index;   /**< The map items by target path */
     bson_t* tgt_payload;
     bson_t mapped_payload;
 };
 
+/**
+ * A configuration value of a net, resolved once from a dot-notation key and
+ * cached until the net configuration is replaced (see smx_net_set_conf()).
+ */
+struct smx_config_handle_s
+{
+    void* h;                 /**< The net handler */
+    char* search;            /**< The dot-notation key of the value */
+    bson_type_t type;        /**< The requested value type */
+    bool is_resolved;        /**< Is the cached value valid? */
+    unsigned int conf_version; /**< The configuration version of the cache */
+    smx_config_error_t err;  /**< The error of the last resolution */
+    unsigned int len;        /**< The length of a string value */
+    union {
+        double v_double;
+        int32_t v_int32;
+        bool v_bool;
+        const char* v_utf8;
+    } val;                   /**< The cached value */
+};
+
+/**
+ * A slot of a hash map.
+ */
+struct smx_hmap_item_s
+{
+    char*       key;        /**< the key or NULL if the slot is free */
+    uint64_t    hash;       /**< the hash of the key */
+    void*       val;        /**< the value */
+};
+
+/**
+ * A hash map with string keys, using open addressing with linear probing.
+ */
+struct smx_hmap_s
+{
+    smx_hmap_item_t*    items;  /**< the slots */
+    size_t              size;   /**< the number of slots, a power of two */
+    size_t              count;  /**< the number of occupied slots */
+};
+
 /**
  * @brief Streamix fifo structure
  *
@@ -324,6 +404,7 @@ struct smx_fifo_s
 struct smx_fifo_item_s
 {
     smx_msg_t*       msg;        /**< ::smx_msg_s */
+    uint64_t         enqueue_ts; /**< enqueue time in ns or 0 */
     smx_fifo_item_t* next;       /**< pointer to the next item */
     smx_fifo_item_t* prev;       /**< pointer to the previous item */
 };
@@ -353,6 +434,11 @@ struct smx_msg_s
     void* (*copy)( void*, size_t ); /**< pointer to a fct making a deep copy */
     void  (*destroy)( void* );      /**< pointer to a fct that frees data */
     void* (*unpack)( void* );       /**< pointer to a fct that unpacks data */
+    uint64_t partition_key;         /**< the key to select a net replica */
+    bool has_partition_key;         /**< is the partition key set? */
+    uint64_t create_ts;             /**< CLOCK_MONOTONIC creation time in ns */
+    uint64_t origin_ts;             /**< creation time of the first ancestor */
+    bool is_traced;                 /**< is the message sampled by the profiler? */
 };
 
 /**
@@ -363,6 +449,7 @@ struct smx_net_s
     bool                has_profiler; /**< is profiler enabled? */
     bool                has_type_filter; /**< is type filter enabled? */
     bool                is_disabled; /**< is net disabled */
+    bool                is_rn;      /**< is the net a routing node? */
     /** the thread priority of the net. 0 means ET, >0 means TT */
     int                 priority;
     unsigned int        id;           /**< a unique net id */
@@ -370,6 +457,7 @@ struct smx_net_s
     /** The expected loop rate per second. */
     int                 expected_rate;
     zlog_category_t*    cat;          /**< the log category */
+    int                 log_level;    /**< the lowest enabled level of `cat` */
     smx_net_sig_t*      sig;          /**< the net port signature */
     /** port name on which to receive the dynamic configuration  */
     const char*         conf_port_name;
@@ -377,6 +465,8 @@ struct smx_net_s
     int                 conf_port_timeout;
     void*               attr;         /**< custom attributes of special nets */
     void*               conf;         /**< pointer to the net configuration */
+    /** incremented whenever `conf` is replaced, see smx_net_set_conf() */
+    unsigned int        conf_version;
     bson_t*             dyn_conf;     /**< pointer to the dynamic configuration */
     bson_t*             static_conf;  /**< pointer to the static configuration */
     char*               name;         /**< the name of the net */
@@ -388,6 +478,52 @@ struct smx_net_s
     struct timespec     last_count_wall;   /**< start time of a net (after init) */
     struct timespec     start_wall;   /**< start time of a net (after init) */
     struct timespec     end_wall;     /**< end time of a net (befoer cleanup) */
+    /** the number of replicas to run in parallel, 0 or 1 means no replicas */
+    int                 replicas;
+    smx_net_group_t*    group;        /**< ::smx_net_group_s or NULL */
+    /** the wakeup threshold of all input channels, 0 means no moderation */
+    int                 wake_threshold;
+    /** the wakeup delay of all input channels, 0 means no moderation */
+    int                 wake_delay_us;
+    /** the enabled profiler event classes, 0 if the profiler is disabled */
+    unsigned int        profiler_mask;
+    /** trace only 1 in N of the messages created by the net, 0 or 1 means all */
+    int                 profiler_sample_rate;
+    /** the number of messages created by the net, used for sampling */
+    unsigned long       profiler_sample_count;
+    /** record the end-to-end latency of messages on all input channels */
+    bool                has_latency_hist;
+    /** record the queueing delay of messages on all input channels */
+    bool                has_queue_hist;
+    /** the ring buffer of the built-in tracer or NULL */
+    smx_tracer_ring_t*  tracer_ring;
+    smx_hist_t*         impl_hist;    /**< box implementation time in ns */
+    smx_hist_t*         loop_hist;    /**< net loop period in ns */
+    smx_metrics_net_t*  metrics;      /**< the live metrics record or NULL */
+};
+
+/**
+ * @brief A group of net replicas
+ *
+ * The replicas of a net share the same box implementation and configuration
+ * but run in their own thread with their own state. Each input of the net is
+ * distributed among the replicas by a dispatcher net and each output is
+ * collected from the replicas by a merger net. In a partitioned group the
+ * dispatchers route messages by their partition key and the outputs are
+ * collected by routing nodes.
+ */
+struct smx_net_group_s
+{
+    int             count;          /**< the number of replicas */
+    smx_net_t**     replicas;       /**< the replicas, index 0 is the original */
+    int             dispatch_count; /**< the number of dispatcher nets */
+    smx_net_t**     dispatchers;    /**< one dispatcher net per input port */
+    int             merge_count;    /**< the number of merger nets */
+    smx_net_t**     mergers;        /**< one merger net per output port */
+    int             ch_count;       /**< the number of group channels */
+    smx_channel_t** chs;            /**< the channels created for the group */
+    /** dispatch by partition key and merge non-deterministically */
+    bool            is_partitioned;
 };
 
 /**
@@ -445,6 +581,11 @@ struct smx_rts_s
     struct timespec end_wall;       /**< the walltime of the application end. */
     smx_rts_shared_state_t* shared_state[SMX_MAX_NETS];
     pthread_mutex_t net_mutex;      /**< mutual exclusion */
+    smx_tracer_t* tracer;           /**< the built-in tracer or NULL */
+    int net_end_cnt;                /**< the number of terminated nets */
+    smx_metrics_t* metrics;         /**< the live metrics or NULL */
+    smx_hmap_t* net_conf_index;     /**< the `_nets` levels by path */
+    smx_hmap_t* net_conf_files;     /**< the parsed net config files by path */
 };
 
 #endif /* SMXTYPES_H */
@@ -9,12 +9,23 @@
  * Utility functions for the runtime system library of Streamix
  */
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
+#include "smxtypes.h"
 
 #ifndef SMXUTILS_H
 #define SMXUTILS_H
 
 #define SMX_MAX(X, Y) (((X) > (Y)) ? (X) : (Y))
+#define SMX_MIN(X, Y) (((X) < (Y)) ? (X) : (Y))
+
+/**
+ * The initial value of an incremental hash, see smx_hash_bytes()
+ */
+#define SMX_HASH_INIT 0xcbf29ce484222325ULL
 
 /**
  * ASCII definition of an input port
@@ -180,6 +191,138 @@
  */
 #define STRINGIFY(x) #x
 
+/**
+ * Compute the time elapsed between two timestamps.
+ *
+ * @param start
+ *  The earlier timestamp.
+ * @param end
+ *  The later timestamp.
+ * @return
+ *  The elapsed time in nanoseconds or 0 if end lies before start.
+ */
+uint64_t smx_get_elapsed_ns( struct timespec* start, struct timespec* end );
+
+/**
+ * Get the current CLOCK_MONOTONIC time.
+ *
+ * @return
+ *  The current time in nanoseconds.
+ */
+uint64_t smx_get_time_ns();
+
+/**
+ * Compute a 64 bit hash of a byte buffer (FNV-1a). The hash can be computed
+ * incrementally by passing the hash of the previous buffer.
+ *
+ * @param hash
+ *  The hash of the previous buffer or #SMX_HASH_INIT.
+ * @param data
+ *  The buffer to hash.
+ * @param len
+ *  The length of the buffer in bytes.
+ * @return
+ *  The hash value.
+ */
+uint64_t smx_hash_bytes( uint64_t hash, const void* data, size_t len );
+
+/**
+ * Compute a 64 bit hash of a string (FNV-1a).
+ *
+ * @param str
+ *  The NULL terminated string to hash.
+ * @return
+ *  The hash value.
+ */
+uint64_t smx_hash_str( const char* str );
+
+/**
+ * Scramble a 64 bit integer such that consecutive values are spread evenly
+ * over the whole value range (the finalizer of splitmix64).
+ *
+ * @param val
+ *  The value to hash.
+ * @return
+ *  The hash value.
+ */
+uint64_t smx_hash_u64( uint64_t val );
+
+/**
+ * Create an empty hash map.
+ *
+ * @param size
+ *  The expected number of items. The map grows if more items are added.
+ * @return
+ *  A pointer to the hash map or NULL on failure.
+ */
+smx_hmap_t* smx_hmap_create( size_t size );
+
+/**
+ * Destroy a hash map and all of its keys.
+ *
+ * @param map
+ *  A pointer to the hash map. NULL is ignored.
+ * @param destroy
+ *  A function to destroy the values or NULL if the values are not owned by
+ *  the map.
+ */
+void smx_hmap_destroy( smx_hmap_t* map, void ( *destroy )( void* ) );
+
+/**
+ * Get the value of a key.
+ *
+ * @param map
+ *  A pointer to the hash map.
+ * @param key
+ *  The key.
+ * @return
+ *  The value or NULL if the key is not in the map.
+ */
+void* smx_hmap_get( smx_hmap_t* map, const char* key );
+
+/**
+ * Grow the hash map to a new number of slots and rehash all items.
+ *
+ * @param map
+ *  A pointer to the hash map.
+ * @param size
+ *  The new number of slots, a power of two.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_hmap_grow( smx_hmap_t* map, size_t size );
+
+/**
+ * Set the value of a key. The key is copied. If the key is already in the
+ * map, its value is replaced.
+ *
+ * @param map
+ *  A pointer to the hash map.
+ * @param key
+ *  The key.
+ * @param val
+ *  The value.
+ * @return
+ *  0 on success or -1 on failure.
+ */
+int smx_hmap_set( smx_hmap_t* map, const char* key, void* val );
+
+/**
+ * Initialise a mutex. If priority inheritance is requested, the mutex uses the
+ * protocol `PTHREAD_PRIO_INHERIT` which is required to avoid priority
+ * inversion if TT nets (nets with a priority > 0) compete for the mutex.
+ * Otherwise an adaptive mutex is created which avoids the more expensive PI
+ * futex path of the kernel.
+ *
+ * @param mutex
+ *  A pointer to the mutex to initialise.
+ * @param is_prio_inherit
+ *  If true, a mutex with priority inheritance is created.
+ * @return
+ *  0 on success or an error number on failure.
+ */
+int smx_mutex_init( pthread_mutex_t* mutex, bool is_prio_inherit );
+
 /**
  * Allocate space with malloc and log an error if malloc fails
  *
@@ -0,0 +1,206 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Dispatcher box implementation for the runtime system library of Streamix
+ */
+
+#include <stdbool.h>
+#include "box_smx_dispatch.h"
+#include "smxutils.h"
+#include "smxch.h"
+#include "smxlog.h"
+#include "smxnet.h"
+#include "smxmsg.h"
+
+/*****************************************************************************/
+double smx_dispatch_get_skew( smx_net_t* net )
+{
+    int i;
+    unsigned long count;
+    unsigned long max = 0;
+    unsigned long sum = 0;
+    smx_dispatch_t* dispatch = net->attr;
+
+    if( dispatch == NULL || dispatch->count == 0 )
+        return 0;
+
+    for( i = 0; i < dispatch->count; i++ )
+    {
+        count = __atomic_load_n( &dispatch->msg_counts[i], __ATOMIC_RELAXED );
+        sum += count;
+        if( count > max )
+            max = count;
+    }
+    if( sum == 0 )
+        return 0;
+
+    return ( double )max * dispatch->count / sum;
+}
+
+/*****************************************************************************/
+void smx_dispatch_log_partitions( smx_net_t* net )
+{
+    int i;
+    unsigned long count;
+    unsigned long unkeyed_count;
+    unsigned long sum = 0;
+    double skew;
+    smx_dispatch_t* dispatch = net->attr;
+
+    if( dispatch == NULL )
+        return;
+
+    for( i = 0; i < dispatch->count; i++ )
+        sum += __atomic_load_n( &dispatch->msg_counts[i], __ATOMIC_RELAXED );
+
+    for( i = 0; i < dispatch->count; i++ )
+    {
+        count = __atomic_load_n( &dispatch->msg_counts[i], __ATOMIC_RELAXED );
+        SMX_LOG_NET( net, notice, "partition %d: %lu messages (%.1f%%)", i,
+                count, ( sum == 0 ) ? 0 : 100.0 * count / sum );
+    }
+
+    unkeyed_count = __atomic_load_n( &dispatch->unkeyed_count,
+            __ATOMIC_RELAXED );
+    skew = smx_dispatch_get_skew( net );
+    if( dispatch->is_partitioned && skew > SMX_DISPATCH_SKEW_WARN )
+    {
+        SMX_LOG_NET( net, warn, "partition skew of %.2f (%lu messages without"
+                " partition key), consider to rebalance the partition keys",
+                skew, unkeyed_count );
+    }
+    else
+    {
+        SMX_LOG_NET( net, notice, "partition skew of %.2f (%lu messages without"
+                " partition key)", skew, unkeyed_count );
+    }
+}
+
+/*****************************************************************************/
+void smx_net_destroy_dispatch( smx_net_t* net )
+{
+    smx_dispatch_t* dispatch;
+
+    if( net == NULL || net->attr == NULL )
+        return;
+
+    dispatch = net->attr;
+    if( dispatch->msg_counts != NULL )
+        free( dispatch->msg_counts );
+    free( dispatch );
+    net->attr = NULL;
+}
+
+/*****************************************************************************/
+void smx_net_init_dispatch( smx_net_t* net, bool is_partitioned )
+{
+    int i;
+    smx_dispatch_t* dispatch;
+
+    if( net == NULL || net->sig == NULL )
+    {
+        SMX_LOG_MAIN( main, fatal,
+                "unable to init dispatcher: not initialised" );
+        return;
+    }
+
+    dispatch = smx_malloc( sizeof( struct smx_dispatch_s ) );
+    if( dispatch == NULL )
+        return;
+
+    dispatch->is_partitioned = is_partitioned;
+    dispatch->count = net->sig->out.len;
+    dispatch->unkeyed_count = 0;
+    dispatch->msg_counts = smx_malloc( sizeof( unsigned long )
+            * dispatch->count );
+    if( dispatch->msg_counts == NULL )
+    {
+        free( dispatch );
+        return;
+    }
+    for( i = 0; i < dispatch->count; i++ )
+        dispatch->msg_counts[i] = 0;
+
+    net->attr = dispatch;
+}
+
+/*****************************************************************************/
+int smx_dispatch( void* h, void* state )
+{
+    net_smx_dispatch_state_t* dispatch_state = state;
+    smx_net_t* net = h;
+    smx_dispatch_t* dispatch = net->attr;
+    smx_msg_t* msg;
+    int idx;
+    int count_out = net->sig->out.len;
+    smx_channel_t** chs_out = net->sig->out.ports;
+
+    msg = smx_channel_read( h, net->sig->in.ports[0] );
+    if( msg == NULL )
+        return SMX_NET_RETURN;
+
+    if( dispatch != NULL && dispatch->is_partitioned && msg->has_partition_key )
+    {
+        idx = smx_hash_u64( msg->partition_key ) % count_out;
+    }
+    else
+    {
+        if( dispatch != NULL && dispatch->is_partitioned )
+            __atomic_fetch_add( &dispatch->unkeyed_count, 1,
+                    __ATOMIC_RELAXED );
+        idx = dispatch_state->next_idx;
+        dispatch_state->next_idx++;
+        if( dispatch_state->next_idx >= count_out )
+            dispatch_state->next_idx = 0;
+    }
+
+    if( dispatch != NULL )
+        __atomic_fetch_add( &dispatch->msg_counts[idx], 1,
+                __ATOMIC_RELAXED );
+
+    smx_channel_write( h, chs_out[idx], msg );
+
+    return SMX_NET_RETURN;
+}
+
+/*****************************************************************************/
+int smx_dispatch_init( void* h, void** state )
+{
+    net_smx_dispatch_state_t* dispatch_state;
+    smx_net_t* net = h;
+
+    if( net->sig->in.len != 1 || net->sig->out.len < 1 )
+    {
+        SMX_LOG_NET( net, error, "a dispatcher requires one input and at"
+                " least one output (in: %d, out: %d)", net->sig->in.len,
+                net->sig->out.len );
+        return -1;
+    }
+
+    dispatch_state = smx_malloc( sizeof( struct net_smx_dispatch_state_s ) );
+    if( dispatch_state == NULL )
+        return -1;
+
+    dispatch_state->next_idx = 0;
+    *state = dispatch_state;
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_dispatch_cleanup( void* h, void* state )
+{
+    smx_dispatch_log_partitions( h );
+    if( state != NULL )
+        free( state );
+}
+
+/*****************************************************************************/
+void* start_routine_smx_dispatch( void* h )
+{
+    return smx_net_start_routine( h, smx_dispatch, smx_dispatch_init,
+            smx_dispatch_cleanup );
+}
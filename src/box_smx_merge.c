@@ -0,0 +1,88 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Merger box implementation for the runtime system library of Streamix
+ */
+
+#include <stdbool.h>
+#include "box_smx_merge.h"
+#include "smxutils.h"
+#include "smxch.h"
+#include "smxlog.h"
+#include "smxnet.h"
+#include "smxmsg.h"
+
+/*****************************************************************************/
+int smx_merge( void* h, void* state )
+{
+    net_smx_merge_state_t* merge_state = state;
+    smx_net_t* net = h;
+    smx_msg_t* msg;
+    smx_channel_t* ch;
+    int count_in = net->sig->in.len;
+
+    ch = net->sig->in.ports[merge_state->next_idx];
+    msg = smx_channel_read( h, ch );
+    if( msg == NULL )
+    {
+        if( smx_get_read_error( ch ) == SMX_CHANNEL_ERR_NO_TARGET )
+        {
+            // the replicas are served in order: if the expected replica has
+            // terminated without producing a message, so have the others
+            SMX_LOG_NET( net, debug, "replica on port %d has terminated",
+                    merge_state->next_idx );
+            return SMX_NET_END;
+        }
+        return SMX_NET_RETURN;
+    }
+
+    merge_state->next_idx++;
+    if( merge_state->next_idx >= count_in )
+        merge_state->next_idx = 0;
+
+    smx_channel_write( h, net->sig->out.ports[0], msg );
+
+    return SMX_NET_RETURN;
+}
+
+/*****************************************************************************/
+int smx_merge_init( void* h, void** state )
+{
+    net_smx_merge_state_t* merge_state;
+    smx_net_t* net = h;
+
+    if( net->sig->in.len < 1 || net->sig->out.len != 1 )
+    {
+        SMX_LOG_NET( net, error, "a merger requires at least one input and"
+                " one output (in: %d, out: %d)", net->sig->in.len,
+                net->sig->out.len );
+        return -1;
+    }
+
+    merge_state = smx_malloc( sizeof( struct net_smx_merge_state_s ) );
+    if( merge_state == NULL )
+        return -1;
+
+    merge_state->next_idx = 0;
+    *state = merge_state;
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_merge_cleanup( void* h, void* state )
+{
+    ( void )( h );
+    if( state != NULL )
+        free( state );
+}
+
+/*****************************************************************************/
+void* start_routine_smx_merge( void* h )
+{
+    return smx_net_start_routine( h, smx_merge, smx_merge_init,
+            smx_merge_cleanup );
+}
@@ -27,6 +27,16 @@ void smx_connect_rn( smx_channel_t* ch, smx_net_t* rn )
                 "unable to connect routing node: not initialised %s", elem );
         return;
     }
+    if( ch->type == SMX_RENDEZVOUS )
+    {
+        // a routing node peeks at its inputs, this requires a buffer
+        SMX_LOG_CH( ch, warn, "a rendezvous channel cannot be connected to a"
+                " routing node, using a fifo of length 1 instead" );
+        smx_fifo_destroy( ch->fifo );
+        ch->fifo = smx_fifo_create( 1 );
+        ch->type = SMX_FIFO;
+        ch->sink->state = SMX_CHANNEL_READY;
+    }
     ch->collector = rn->attr;
     ch->collector->ch_count++;
 }
@@ -49,6 +59,7 @@ void smx_net_init_rn( smx_net_t* rn )
         return;
     }
     rn->attr = smx_collector_create();
+    rn->is_rn = true;
 }
 
 /*****************************************************************************/
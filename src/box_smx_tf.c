@@ -179,18 +179,20 @@ void smx_tf_propagate_msgs( smx_net_t* h, int copy )
         {
             if( msg == NULL )
             {
-                zlog_error( ch_in[i]->cat,
-                        "rt net '%s(%d)' missed deadline to produce: no message"
-                        " produced", producer->name, producer->id );
-                smx_profiler_log_ch( h, ch_in[i], NULL,
+                SMX_LOG_CH_ANOMALY( ch_in[i], ch_in[i]->source, error,
+                        "rt net '%s(%d)' missed deadline to produce: no"
+                        " message produced", producer->name,
+                        producer->id );
+                SMX_PROFILER_LOG_CH( h, ch_in[i], NULL,
                         SMX_PROFILER_ACTION_CH_DL_MISS_SRC, 0 );
             }
             if( ch_in[i]->fifo->copy )
             {
-                zlog_warn( ch_in[i]->cat,
-                        "rt net '%s(%d)' missed deadline to produce: previous"
-                        " message duplicated", producer->name, producer->id );
-                smx_profiler_log_ch( h, ch_in[i], NULL,
+                SMX_LOG_CH_ANOMALY( ch_in[i], ch_in[i]->source, warn,
+                        "rt net '%s(%d)' missed deadline to produce:"
+                        " previous message duplicated", producer->name,
+                        producer->id );
+                SMX_PROFILER_LOG_CH( h, ch_in[i], NULL,
                         SMX_PROFILER_ACTION_CH_DL_MISS_SRC_CP, 0 );
             }
         }
@@ -198,19 +200,20 @@ void smx_tf_propagate_msgs( smx_net_t* h, int copy )
         {
             if( msg == NULL )
             {
-                zlog_warn( ch_in[i]->cat,
+                SMX_LOG_CH_ANOMALY( ch_in[i], ch_in[i]->source, warn,
                         "non-rt net '%s(%d)' missed tt interval to produce:"
-                        " no message produced", producer->name, producer->id );
-                smx_profiler_log_ch( h, ch_in[i], NULL,
+                        " no message produced", producer->name,
+                        producer->id );
+                SMX_PROFILER_LOG_CH( h, ch_in[i], NULL,
                         SMX_PROFILER_ACTION_CH_TT_MISS_SRC, 0 );
             }
             if( ch_in[i]->fifo->copy )
             {
-                zlog_notice( ch_in[i]->cat,
+                SMX_LOG_CH_ANOMALY( ch_in[i], ch_in[i]->source, notice,
                         "non-rt net '%s(%d)' missed tt interval to produce:"
                         " previous message duplicated", producer->name,
                         producer->id );
-                smx_profiler_log_ch( h, ch_in[i], NULL,
+                SMX_PROFILER_LOG_CH( h, ch_in[i], NULL,
                         SMX_PROFILER_ACTION_CH_TT_MISS_SRC_CP, 0 );
             }
         }
@@ -225,18 +228,18 @@ void smx_tf_propagate_msgs( smx_net_t* h, int copy )
                 consumer = ch_out[i]->source->net;
                 if( consumer->priority > 0)
                 {
-                    zlog_error( ch_out[i]->cat,
+                    SMX_LOG_CH_ANOMALY( ch_out[i], ch_out[i]->sink, error,
                             "rt net '%s(%d)' missed deadline to consume",
                             consumer->name, consumer->id );
-                    smx_profiler_log_ch( h, ch_out[i], NULL,
+                    SMX_PROFILER_LOG_CH( h, ch_out[i], NULL,
                             SMX_PROFILER_ACTION_CH_DL_MISS_SINK, 0 );
                 }
                 else
                 {
-                    zlog_warn( ch_out[i]->cat,
-                            "non-rt '%s(%d)' net missed tt interval to consume",
-                            consumer->name, consumer->id );
-                    smx_profiler_log_ch( h, ch_out[i], NULL,
+                    SMX_LOG_CH_ANOMALY( ch_out[i], ch_out[i]->sink, warn,
+                            "non-rt '%s(%d)' net missed tt interval to"
+                            " consume", consumer->name, consumer->id );
+                    SMX_PROFILER_LOG_CH( h, ch_out[i], NULL,
                             SMX_PROFILER_ACTION_CH_TT_MISS_SINK, 0 );
                 }
             }
@@ -15,6 +15,8 @@
 #include <sys/timerfd.h>
 #include <unistd.h>
 #include "smxch.h"
+#include "smxhist.h"
+#include "smxmetrics.h"
 #include "smxmsg.h"
 #include "smxutils.h"
 #include "smxlog.h"
@@ -65,7 +67,6 @@ smx_channel_t* smx_channel_create( int* ch_cnt, int len,
         smx_channel_type_t type, int id, const char* name,
         const char* cat_name )
 {
-    pthread_mutexattr_t mutexattr_prioinherit;
     if( id >= SMX_MAX_CHS )
     {
         SMX_LOG_MAIN( main, fatal, "channel count exeeds maximum %d", id );
@@ -75,20 +76,29 @@ smx_channel_t* smx_channel_create( int* ch_cnt, int len,
     if( ch == NULL )
         return NULL;
 
+    if( type == SMX_FIFO && len == 0 )
+        // a fifo without buffer space is a rendezvous channel
+        type = SMX_RENDEZVOUS;
+    if( type == SMX_RENDEZVOUS )
+        len = 0;
+
     SMX_LOG_MAIN( ch, info, "create channel '%s(%d)' of length %d", name, id,
             len );
-    pthread_mutexattr_init( &mutexattr_prioinherit );
-    pthread_mutexattr_setprotocol( &mutexattr_prioinherit,
-            PTHREAD_PRIO_INHERIT );
-
-    pthread_mutex_init( &ch->ch_mutex, &mutexattr_prioinherit );
+    // the attached nets are not known yet, see smx_channel_init_mutex()
+    smx_mutex_init( &ch->ch_mutex, true );
+    ch->is_prio_inherit = true;
     ch->id = id;
     ch->type = type;
     ch->fifo = smx_fifo_create( len );
+    ch->handoff = NULL;
+    ch->latency_hist = NULL;
+    ch->queue_hist = NULL;
+    ch->metrics = NULL;
     ch->collector = NULL;
     ch->guard = NULL;
     ch->name = ( name == NULL ) ? NULL : strdup( name );
     ch->cat = zlog_get_category( cat_name );
+    ch->log_level = smx_log_get_level( ch->cat );
     ch->sink = smx_channel_create_end();
     ch->source = smx_channel_create_end();
     ch->source->state = SMX_CHANNEL_PENDING;
@@ -98,6 +108,11 @@ smx_channel_t* smx_channel_create( int* ch_cnt, int len,
         // do not block on decouped output
         ch->source->state = SMX_CHANNEL_UNINITIALISED;
     }
+    if( type == SMX_RENDEZVOUS )
+    {
+        // a producer blocks until a consumer is waiting for the message
+        ch->sink->state = SMX_CHANNEL_PENDING;
+    }
     if( ch->sink == NULL || ch->source == NULL )
     {
         smx_channel_destroy( ch );
@@ -122,6 +137,16 @@ smx_channel_end_t* smx_channel_create_end()
     end->content_filter = NULL;
     end->timeout.tv_sec = 0;
     end->timeout.tv_nsec = 0;
+    end->wake_threshold = 0;
+    end->wake_delay_us = 0;
+    end->wake_ts.tv_sec = 0;
+    end->wake_ts.tv_nsec = 0;
+    end->block_time = 0;
+    end->block_max = 0;
+    end->block_count = 0;
+    end->anomaly_ts = 0;
+    end->anomaly_suppressed = 0;
+    end->anomaly_suppressed_total = 0;
     pthread_cond_init( &end->ch_cv, NULL );
     return end;
 }
@@ -141,7 +166,31 @@ void smx_channel_destroy( smx_channel_t* ch )
         SMX_LOG_CH( ch, notice, "tail of fifo was overwritten %d times",
                 ch->fifo->overwrite );
     }
+    if( ch->source != NULL && ch->sink != NULL
+            && ( ch->source->anomaly_suppressed_total > 0
+                || ch->sink->anomaly_suppressed_total > 0 ) )
+    {
+        SMX_LOG_CH( ch, notice, "suppressed %lu anomaly logs of the consumer"
+                " and %lu of the producer",
+                ch->source->anomaly_suppressed_total,
+                ch->sink->anomaly_suppressed_total );
+    }
+    if( ch->source != NULL && ch->sink != NULL
+            && ( ch->source->block_count > 0 || ch->sink->block_count > 0 ) )
+    {
+        SMX_LOG_CH( ch, info, "blocked read: %lu us in %lu episodes (max %lu"
+                " us), blocked write: %lu us in %lu episodes (max %lu us)",
+                ch->source->block_time / 1000, ch->source->block_count,
+                ch->source->block_max / 1000, ch->sink->block_time / 1000,
+                ch->sink->block_count, ch->sink->block_max / 1000 );
+    }
+    smx_hist_log( ch->latency_hist, ch->cat, "end-to-end latency" );
+    smx_hist_destroy( ch->latency_hist );
+    smx_hist_log( ch->queue_hist, ch->cat, "queueing delay" );
+    smx_hist_destroy( ch->queue_hist );
     smx_fifo_destroy( ch->fifo );
+    if( ch->handoff != NULL )
+        smx_msg_destroy( NULL, ch->handoff, true );
     smx_channel_destroy_end( ch->sink );
     smx_channel_destroy_end( ch->source );
     pthread_mutex_destroy( &ch->ch_mutex );
@@ -164,6 +213,122 @@ void smx_channel_destroy_end( smx_channel_end_t* end )
     free( end );
 }
 
+/*****************************************************************************/
+void smx_channel_end_add_block_time( smx_channel_end_t* end,
+        struct timespec* start )
+{
+    struct timespec now;
+    uint64_t elapsed;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    elapsed = smx_get_elapsed_ns( start, &now );
+    // only the connected net writes, readers may query at runtime
+    __atomic_store_n( &end->block_time, end->block_time + elapsed,
+            __ATOMIC_RELAXED );
+    __atomic_store_n( &end->block_count, end->block_count + 1,
+            __ATOMIC_RELAXED );
+    if( elapsed > end->block_max )
+        __atomic_store_n( &end->block_max, elapsed, __ATOMIC_RELAXED );
+    smx_metrics_set_net_state( end->net, SMX_METRICS_NET_RUN );
+}
+
+/*****************************************************************************/
+bool smx_channel_end_is_anomaly_logged( smx_channel_t* ch,
+        smx_channel_end_t* end, int level )
+{
+    uint64_t now;
+
+    if( level < SMX_LOG_MIN_LEVEL_CH || level < ch->log_level )
+        return false;
+
+    now = smx_get_time_ns();
+    if( end->anomaly_ts != 0 && now - end->anomaly_ts
+            < SMX_CHANNEL_ANOMALY_LOG_INTERVAL_MS * 1000000ULL )
+    {
+        end->anomaly_suppressed++;
+        end->anomaly_suppressed_total++;
+        return false;
+    }
+
+    if( end->anomaly_suppressed > 0 )
+    {
+        smx_channel_end_log_suppressed( ch, end, level,
+                ( now - end->anomaly_ts ) / 1000000 );
+        end->anomaly_suppressed = 0;
+    }
+    end->anomaly_ts = now;
+    return true;
+}
+
+/*****************************************************************************/
+void smx_channel_end_log_suppressed( smx_channel_t* ch,
+        smx_channel_end_t* end, int level, uint64_t interval_ms )
+{
+    switch( level )
+    {
+        case SMX_LOG_LEVEL_debug:
+            SMX_LOG_CH( ch, debug, "suppressed %lu anomaly logs in the last"
+                    " %lu ms", end->anomaly_suppressed, interval_ms );
+            break;
+        case SMX_LOG_LEVEL_info:
+            SMX_LOG_CH( ch, info, "suppressed %lu anomaly logs in the last"
+                    " %lu ms", end->anomaly_suppressed, interval_ms );
+            break;
+        case SMX_LOG_LEVEL_notice:
+            SMX_LOG_CH( ch, notice, "suppressed %lu anomaly logs in the last"
+                    " %lu ms", end->anomaly_suppressed, interval_ms );
+            break;
+        case SMX_LOG_LEVEL_warn:
+            SMX_LOG_CH( ch, warn, "suppressed %lu anomaly logs in the last"
+                    " %lu ms", end->anomaly_suppressed, interval_ms );
+            break;
+        default:
+            SMX_LOG_CH( ch, error, "suppressed %lu anomaly logs in the last"
+                    " %lu ms", end->anomaly_suppressed, interval_ms );
+    }
+}
+
+/*****************************************************************************/
+uint64_t smx_channel_get_latency( smx_channel_t* ch, double percentile )
+{
+    if( ch == NULL || ch->latency_hist == NULL )
+        return 0;
+
+    return smx_hist_get_percentile( ch->latency_hist, percentile );
+}
+
+/*****************************************************************************/
+uint64_t smx_channel_get_queue_delay( smx_channel_t* ch, double percentile )
+{
+    if( ch == NULL || ch->queue_hist == NULL )
+        return 0;
+
+    return smx_hist_get_percentile( ch->queue_hist, percentile );
+}
+
+/*****************************************************************************/
+void smx_channel_init_mutex( smx_channel_t* ch, bool is_prio_inherit )
+{
+    if( ch == NULL || ch->is_prio_inherit == is_prio_inherit )
+        return;
+
+    pthread_mutex_destroy( &ch->ch_mutex );
+    smx_mutex_init( &ch->ch_mutex, is_prio_inherit );
+    ch->is_prio_inherit = is_prio_inherit;
+    SMX_LOG_CH( ch, debug, "using %s mutex",
+            is_prio_inherit ? "priority inheritance" : "adaptive" );
+}
+
+/*****************************************************************************/
+bool smx_channel_is_rt( smx_channel_t* ch )
+{
+    if( ch == NULL )
+        return false;
+
+    return ( ch->sink->net != NULL && ch->sink->net->priority > 0 )
+        || ( ch->source->net != NULL && ch->source->net->priority > 0 );
+}
+
 #ifndef SMX_TESTING
 
 /*****************************************************************************/
@@ -171,7 +336,11 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
 {
     int rc = 0;
     int nsec_sum;
+    bool is_blocked;
+    bool has_deadline;
     struct timespec ts;
+    struct timespec read_ts;
+    struct timespec block_start;
     smx_msg_t* msg = NULL;
     if( ch == NULL )
         return NULL;
@@ -183,18 +352,69 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
     }
 
     pthread_mutex_lock( &ch->ch_mutex);
+    if( ch->type == SMX_RENDEZVOUS && ch->handoff == NULL )
+    {
+        // announce the consumer such that a producer can hand off a message
+        smx_channel_change_write_state( ch, SMX_CHANNEL_READY );
+    }
+    is_blocked = ( ch->source->state == SMX_CHANNEL_PENDING );
+    if( is_blocked )
+    {
+        clock_gettime( CLOCK_MONOTONIC, &block_start );
+        smx_metrics_set_net_state( ch->source->net,
+                SMX_METRICS_NET_BLOCKED_READ );
+    }
     while( ch->source->state == SMX_CHANNEL_PENDING && rc == 0 )
     {
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_READ_BLOCK,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_READ_BLOCK,
                 ch->fifo->count );
-        SMX_LOG_CH( ch, debug, "waiting for message" );
-        if( ch->source->timeout.tv_sec == 0
+        if( ( ch->source->wake_threshold > 1 || ch->source->wake_delay_us > 0 )
+                && ch->fifo->count > 0 )
+        {
+            // a moderated batch is pending, wait for its deadline or the read
+            // timeout, whichever is earlier, and then read the batch
+            SMX_LOG_CH( ch, debug, "waiting for batch (count: %d)",
+                    ch->fifo->count );
+            has_deadline = ( ch->source->wake_delay_us > 0 );
+            ts = ch->source->wake_ts;
+            if( ch->source->timeout.tv_sec != 0
+                    || ch->source->timeout.tv_nsec != 0 )
+            {
+                clock_gettime( CLOCK_REALTIME, &read_ts );
+                read_ts.tv_sec += ch->source->timeout.tv_sec;
+                nsec_sum = read_ts.tv_nsec + ch->source->timeout.tv_nsec;
+                if( nsec_sum >= 1000000000 )
+                {
+                    read_ts.tv_sec++;
+                    nsec_sum -= 1000000000;
+                }
+                read_ts.tv_nsec = nsec_sum;
+                if( !has_deadline || read_ts.tv_sec < ts.tv_sec
+                        || ( read_ts.tv_sec == ts.tv_sec
+                            && read_ts.tv_nsec < ts.tv_nsec ) )
+                    ts = read_ts;
+                has_deadline = true;
+            }
+            if( has_deadline )
+                rc = pthread_cond_timedwait( &ch->source->ch_cv,
+                        &ch->ch_mutex, &ts );
+            else
+                rc = pthread_cond_wait( &ch->source->ch_cv, &ch->ch_mutex );
+            if( rc == ETIMEDOUT )
+            {
+                smx_channel_change_read_state( ch, SMX_CHANNEL_READY );
+                rc = 0;
+            }
+        }
+        else if( ch->source->timeout.tv_sec == 0
                 && ch->source->timeout.tv_nsec == 0 )
         {
+            SMX_LOG_CH( ch, debug, "waiting for message" );
             rc = pthread_cond_wait( &ch->source->ch_cv, &ch->ch_mutex );
         }
         else
         {
+            SMX_LOG_CH( ch, debug, "waiting for message" );
             clock_gettime( CLOCK_REALTIME, &ts );
             ts.tv_sec += ch->source->timeout.tv_sec;
             nsec_sum = ts.tv_nsec + ch->source->timeout.tv_nsec;
@@ -209,9 +429,18 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
             rc = pthread_cond_timedwait( &ch->source->ch_cv,
                     &ch->ch_mutex, &ts );
         }
-        if( rc == ETIMEDOUT )
+        if( rc == ETIMEDOUT && ch->handoff != NULL )
         {
+            // a message was handed off while timing out, accept it
+            rc = 0;
+        }
+        else if( rc == ETIMEDOUT )
+        {
+            if( ch->type == SMX_RENDEZVOUS )
+                // withdraw the consumer, a producer must not hand off
+                smx_channel_change_write_state( ch, SMX_CHANNEL_PENDING );
             ch->source->err = SMX_CHANNEL_ERR_TIMEOUT;
+            smx_channel_end_add_block_time( ch->source, &block_start );
             pthread_mutex_unlock( &ch->ch_mutex );
             SMX_LOG_CH( ch, debug, "channel read timed out" );
             return NULL;
@@ -219,6 +448,7 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
         else if( rc != 0 )
         {
             ch->source->err = SMX_CHANNEL_ERR_CV;
+            smx_channel_end_add_block_time( ch->source, &block_start );
             pthread_mutex_unlock( &ch->ch_mutex );
             SMX_LOG_CH( ch, error,
                     "channel conditional wait failed with error '%s'",
@@ -226,6 +456,8 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
             return NULL;
         }
     }
+    if( is_blocked )
+        smx_channel_end_add_block_time( ch->source, &block_start );
     switch( ch->type ) {
         case SMX_FIFO:
         case SMX_D_FIFO:
@@ -235,6 +467,9 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
         case SMX_D_FIFO_D:
             msg = smx_fifo_d_read( h, ch, ch->fifo );
             break;
+        case SMX_RENDEZVOUS:
+            msg = smx_rendezvous_read( h, ch );
+            break;
         default:
             pthread_mutex_unlock( &ch->ch_mutex );
             SMX_LOG_CH( ch, error, "undefined channel type '%d'",
@@ -246,9 +481,9 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
     {
         pthread_mutex_lock( &ch->collector->col_mutex );
         ch->collector->count--;
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_COLLECTOR,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_COLLECTOR,
                 ch->collector->count );
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_READ_COLLECTOR,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_READ_COLLECTOR,
                 ch->collector->count );
         SMX_LOG_CH( ch, info, "read from collector (new count: %d)",
                 ch->collector->count );
@@ -258,16 +493,78 @@ smx_msg_t* smx_channel_read( void* h, smx_channel_t* ch )
         }
         pthread_mutex_unlock( &ch->collector->col_mutex );
     }
-    // notify producer that space is available
-    smx_channel_change_write_state( ch, SMX_CHANNEL_READY );
-    smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_READ,
+    // notify producer that space is available (a rendezvous producer is only
+    // notified once the consumer waits for the next message)
+    if( ch->type != SMX_RENDEZVOUS )
+        smx_channel_change_write_state( ch, SMX_CHANNEL_READY );
+    SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_READ,
             ch->fifo->count );
+    smx_metrics_update_ch( ch, true );
     pthread_mutex_unlock( &ch->ch_mutex );
+    if( msg != NULL && ch->latency_hist != NULL )
+        smx_hist_record( ch->latency_hist, smx_msg_get_latency( msg ) );
     return msg;
 }
 
 #endif /* SMX_TESTING */
 
+/*****************************************************************************/
+void smx_channel_log_block_report( smx_channel_t** chs, int ch_cnt,
+        int count )
+{
+    int i, j, k;
+    int best;
+    uint64_t best_time;
+    uint64_t time;
+    bool* is_reported;
+    smx_channel_end_t* end;
+    const char* kinds[] = { "starvation (blocked read)",
+        "backpressure (blocked write)" };
+
+    is_reported = smx_malloc( sizeof( bool ) * ch_cnt );
+    if( is_reported == NULL )
+        return;
+
+    for( k = 0; k < 2; k++ )
+    {
+        for( i = 0; i < ch_cnt; i++ )
+            is_reported[i] = false;
+        SMX_LOG_MAIN( main, notice, "channels with the most %s:", kinds[k] );
+        for( j = 0; j < count; j++ )
+        {
+            // select the channel with the largest not yet reported time
+            best = -1;
+            best_time = 0;
+            for( i = 0; i < ch_cnt; i++ )
+            {
+                if( chs[i] == NULL || is_reported[i] )
+                    continue;
+                end = ( k == 0 ) ? chs[i]->source : chs[i]->sink;
+                time = __atomic_load_n( &end->block_time, __ATOMIC_RELAXED );
+                if( time > best_time )
+                {
+                    best = i;
+                    best_time = time;
+                }
+            }
+            if( best < 0 )
+                break;
+            is_reported[best] = true;
+            end = ( k == 0 ) ? chs[best]->source : chs[best]->sink;
+            SMX_LOG_MAIN( main, notice, " %d. '%s(%d)' of net '%s': %lu us"
+                    " in %lu episodes (max %lu us)", j + 1, chs[best]->name,
+                    chs[best]->id, ( end->net == NULL ) ? "none"
+                    : end->net->name, best_time / 1000,
+                    __atomic_load_n( &end->block_count, __ATOMIC_RELAXED ),
+                    __atomic_load_n( &end->block_max, __ATOMIC_RELAXED )
+                    / 1000 );
+        }
+        if( j == 0 )
+            SMX_LOG_MAIN( main, notice, " none" );
+    }
+    free( is_reported );
+}
+
 /*****************************************************************************/
 int smx_channel_ready_to_read( smx_channel_t* ch )
 {
@@ -281,6 +578,8 @@ int smx_channel_ready_to_read( smx_channel_t* ch )
         case SMX_D_FIFO_D:
         case SMX_FIFO_D:
             return 1;
+        case SMX_RENDEZVOUS:
+            return ( ch->handoff != NULL ) ? 1 : 0;
         default:
             SMX_LOG_CH( ch, error, "undefined channel type '%d'",
                     ch->type );
@@ -302,6 +601,8 @@ int smx_channel_ready_to_write( smx_channel_t* ch )
         case SMX_FIFO_D:
         case SMX_FIFO:
             return ch->fifo->length - ch->fifo->count;
+        case SMX_RENDEZVOUS:
+            return ( ch->sink->state == SMX_CHANNEL_READY ) ? 1 : 0;
         default:
             SMX_LOG_CH( ch, error, "undefined channel type '%d'",
                     ch->type );
@@ -372,6 +673,64 @@ bool smx_channel_set_filter( smx_net_t* h, smx_channel_t* ch, int count, ... )
     return true;
 }
 
+/*****************************************************************************/
+int smx_channel_set_latency_hist( smx_channel_t* ch )
+{
+    if( ch == NULL )
+        return -1;
+
+    if( ch->latency_hist != NULL )
+        return 0;
+
+    ch->latency_hist = smx_hist_create();
+    if( ch->latency_hist == NULL )
+        return -1;
+
+    SMX_LOG_CH( ch, info, "record end-to-end latency" );
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_channel_set_queue_hist( smx_channel_t* ch )
+{
+    if( ch == NULL )
+        return -1;
+
+    if( ch->queue_hist != NULL )
+        return 0;
+
+    ch->queue_hist = smx_hist_create();
+    if( ch->queue_hist == NULL )
+        return -1;
+
+    SMX_LOG_CH( ch, info, "record queueing delay" );
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_channel_set_wake_moderation( smx_channel_t* ch, int threshold,
+        long delay_us )
+{
+    if( ch == NULL || ch->source == NULL || threshold < 0 || delay_us < 0 )
+        return -1;
+
+    pthread_mutex_lock( &ch->ch_mutex );
+    ch->source->wake_threshold = threshold;
+    ch->source->wake_delay_us = delay_us;
+    pthread_mutex_unlock( &ch->ch_mutex );
+    if( threshold > 1 && delay_us == 0 )
+    {
+        SMX_LOG_CH( ch, notice, "wake moderation without delay: a consumer is"
+                " only woken once %d messages are queued", threshold );
+    }
+    else
+    {
+        SMX_LOG_CH( ch, notice, "wake moderation set to %d messages or %ld us",
+                threshold, delay_us );
+    }
+    return 0;
+}
+
 /*****************************************************************************/
 const char* smx_channel_strerror( smx_channel_err_t err )
 {
@@ -407,7 +766,7 @@ const char* smx_channel_strerror( smx_channel_err_t err )
 /*****************************************************************************/
 void smx_channel_terminate_sink( smx_channel_t* ch )
 {
-    zlog_debug( ch->cat, "mark as stale" );
+    SMX_LOG_CH( ch, debug, "mark as stale" );
     pthread_mutex_lock( &ch->ch_mutex );
     smx_channel_change_write_state( ch, SMX_CHANNEL_END );
     pthread_mutex_unlock( &ch->ch_mutex );
@@ -416,12 +775,48 @@ void smx_channel_terminate_sink( smx_channel_t* ch )
 /*****************************************************************************/
 void smx_channel_terminate_source( smx_channel_t* ch )
 {
-    zlog_debug( ch->cat, "mark as stale" );
+    SMX_LOG_CH( ch, debug, "mark as stale" );
     pthread_mutex_lock( &ch->ch_mutex );
     smx_channel_change_read_state( ch, SMX_CHANNEL_END );
     pthread_mutex_unlock( &ch->ch_mutex );
 }
 
+/*****************************************************************************/
+void smx_channel_wake_consumer( smx_channel_t* ch )
+{
+    long nsec_sum;
+    smx_channel_end_t* end = ch->source;
+
+    if( ( end->wake_threshold <= 1 && end->wake_delay_us == 0 )
+            || ch->type == SMX_RENDEZVOUS || ch->type == SMX_FIFO_D
+            || ch->type == SMX_D_FIFO_D || ch->collector != NULL
+            || ( end->wake_threshold > 1
+                && ch->fifo->count >= end->wake_threshold )
+            || ch->fifo->count >= ch->fifo->length )
+    {
+        smx_channel_change_read_state( ch, SMX_CHANNEL_READY );
+        return;
+    }
+
+    if( ch->fifo->count == 1 && end->state == SMX_CHANNEL_PENDING
+            && end->wake_delay_us > 0 )
+    {
+        // first message of a batch, start the wake deadline
+        clock_gettime( CLOCK_REALTIME, &end->wake_ts );
+        end->wake_ts.tv_sec += end->wake_delay_us / 1000000;
+        nsec_sum = end->wake_ts.tv_nsec
+            + ( end->wake_delay_us % 1000000 ) * 1000;
+        if( nsec_sum >= 1000000000 )
+        {
+            end->wake_ts.tv_sec++;
+            nsec_sum -= 1000000000;
+        }
+        end->wake_ts.tv_nsec = nsec_sum;
+        SMX_LOG_CH( ch, debug, "moderated wakeup, start batch" );
+        pthread_cond_signal( &end->ch_cv );
+    }
+}
+
 #ifndef SMX_TESTING
 
 /*****************************************************************************/
@@ -430,6 +825,8 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
     int rc = 0;
     int nsec_sum;
     bool abort = false;
+    bool is_blocked;
+    struct timespec block_start;
     int new_count;
     int i;
     const char* filter;
@@ -492,9 +889,16 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
     }
 
     pthread_mutex_lock( &ch->ch_mutex );
+    is_blocked = ( ch->sink->state == SMX_CHANNEL_PENDING );
+    if( is_blocked )
+    {
+        clock_gettime( CLOCK_MONOTONIC, &block_start );
+        smx_metrics_set_net_state( ch->sink->net,
+                SMX_METRICS_NET_BLOCKED_WRITE );
+    }
     while( ch->sink->state == SMX_CHANNEL_PENDING && rc == 0 )
     {
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_BLOCK,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_BLOCK,
                 ch->fifo->count );
         SMX_LOG_CH( ch, debug, "waiting for free space" );
         if( ch->sink->timeout.tv_sec == 0 && ch->sink->timeout.tv_nsec == 0 )
@@ -520,6 +924,7 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
         if( rc == ETIMEDOUT )
         {
             ch->sink->err = SMX_CHANNEL_ERR_TIMEOUT;
+            smx_channel_end_add_block_time( ch->sink, &block_start );
             pthread_mutex_unlock( &ch->ch_mutex );
             SMX_LOG_CH( ch, debug, "channel write timed out" );
             smx_msg_destroy( h, msg, true );
@@ -528,6 +933,7 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
         else if( rc != 0 )
         {
             ch->source->err = SMX_CHANNEL_ERR_CV;
+            smx_channel_end_add_block_time( ch->sink, &block_start );
             pthread_mutex_unlock( &ch->ch_mutex );
             SMX_LOG_CH( ch, error,
                     "channel conditional wait failed with error '%s'",
@@ -536,6 +942,8 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
             return -1;
         }
     }
+    if( is_blocked )
+        smx_channel_end_add_block_time( ch->sink, &block_start );
     if( ch->sink->state == SMX_CHANNEL_END ) abort = true;
     if( abort )
     {
@@ -573,6 +981,15 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
                 }
             smx_d_fifo_write( h, ch, ch->fifo, msg );
             break;
+        case SMX_RENDEZVOUS:
+            if( ch->guard != NULL )
+                smx_guard_write( h, ch );
+            if( smx_rendezvous_write( h, ch, msg ) < 0 )
+            {
+                SMX_LOG_CH( ch, error, "hand-off to consumer failed" );
+                smx_msg_destroy( h, msg, true );
+            }
+            break;
         default:
             ch->sink->err = SMX_CHANNEL_ERR_UNINITIALISED;
             pthread_mutex_unlock( &ch->ch_mutex );
@@ -585,16 +1002,17 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
         ch->collector->count++;
         new_count = ch->collector->count;
         smx_channel_change_collector_state( ch, SMX_CHANNEL_READY );
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_COLLECTOR,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE_COLLECTOR,
                 new_count );
         SMX_LOG_CH( ch, info, "write to collector (new count: %d)",
                 new_count );
         pthread_mutex_unlock( &ch->collector->col_mutex );
     }
     // notify consumer that messages are available
-    smx_channel_change_read_state( ch, SMX_CHANNEL_READY );
-    smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE,
+    smx_channel_wake_consumer( ch );
+    SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_WRITE,
             ch->fifo->count );
+    smx_metrics_update_ch( ch, false );
     pthread_mutex_unlock( &ch->ch_mutex );
     return 0;
 }
@@ -604,15 +1022,12 @@ int smx_channel_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
 /*****************************************************************************/
 smx_collector_t* smx_collector_create()
 {
-    pthread_mutexattr_t mutexattr_prioinherit;
     smx_collector_t* collector = smx_malloc( sizeof( struct smx_collector_s ) );
     if( collector == NULL )
         return NULL;
 
-    pthread_mutexattr_init( &mutexattr_prioinherit );
-    pthread_mutexattr_setprotocol( &mutexattr_prioinherit,
-            PTHREAD_PRIO_INHERIT );
-    pthread_mutex_init( &collector->col_mutex, &mutexattr_prioinherit );
+    smx_mutex_init( &collector->col_mutex, true );
+    collector->is_prio_inherit = true;
     pthread_cond_init( &collector->col_cv, NULL );
     collector->count = 0;
     collector->ch_count = 0;
@@ -631,6 +1046,18 @@ void smx_collector_destroy( smx_collector_t* collector )
     free( collector );
 }
 
+/*****************************************************************************/
+void smx_collector_init_mutex( smx_collector_t* collector,
+        bool is_prio_inherit )
+{
+    if( collector == NULL || collector->is_prio_inherit == is_prio_inherit )
+        return;
+
+    pthread_mutex_destroy( &collector->col_mutex );
+    smx_mutex_init( &collector->col_mutex, is_prio_inherit );
+    collector->is_prio_inherit = is_prio_inherit;
+}
+
 /*****************************************************************************/
 void smx_collector_terminate( smx_channel_t* ch )
 {
@@ -638,13 +1065,13 @@ void smx_collector_terminate( smx_channel_t* ch )
         return;
     pthread_mutex_lock( &ch->collector->col_mutex );
     ch->collector->ch_count--;
-    zlog_debug( ch->cat, "input channel has terminated, new count: %d",
+    SMX_LOG_CH( ch, debug, "input channel has terminated, new count: %d",
             ch->collector->ch_count );
     pthread_mutex_unlock( &ch->collector->col_mutex );
 
     if( ch->collector->ch_count == 0 )
     {
-        zlog_debug( ch->cat, "mark collector as stale" );
+        SMX_LOG_CH( ch, debug, "mark collector as stale" );
         pthread_mutex_lock( &ch->collector->col_mutex );
         smx_channel_change_collector_state( ch, SMX_CHANNEL_END );
         pthread_mutex_unlock( &ch->collector->col_mutex );
@@ -716,6 +1143,8 @@ smx_fifo_t* smx_fifo_create( int length )
     if( fifo == NULL )
         return NULL;
 
+    fifo->head = NULL;
+    fifo->tail = NULL;
     for( int i=0; i < length; i++ ) {
         fifo->head = smx_malloc( sizeof( struct smx_fifo_item_s ) );
         if( fifo->head == NULL )
@@ -725,6 +1154,7 @@ smx_fifo_t* smx_fifo_create( int length )
         }
 
         fifo->head->msg = NULL;
+        fifo->head->enqueue_ts = 0;
         fifo->head->prev = last_item;
         if( last_item == NULL )
             fifo->tail = fifo->head;
@@ -732,9 +1162,12 @@ smx_fifo_t* smx_fifo_create( int length )
             last_item->next = fifo->head;
         last_item = fifo->head;
     }
-    fifo->head->next = fifo->tail;
-    fifo->tail->prev = fifo->head;
-    fifo->tail = fifo->head;
+    if( length > 0 )
+    {
+        fifo->head->next = fifo->tail;
+        fifo->tail->prev = fifo->head;
+        fifo->tail = fifo->head;
+    }
     fifo->backup = NULL;
     fifo->count = 0;
     fifo->overwrite = 0;
@@ -764,6 +1197,25 @@ void smx_fifo_destroy( smx_fifo_t* fifo )
     free( fifo );
 }
 
+/*****************************************************************************/
+void smx_fifo_item_record_delay( smx_channel_t* ch, smx_fifo_item_t* item )
+{
+    if( ch->queue_hist == NULL || item->enqueue_ts == 0 )
+        return;
+
+    smx_hist_record( ch->queue_hist, smx_get_time_ns() - item->enqueue_ts );
+    item->enqueue_ts = 0;
+}
+
+/*****************************************************************************/
+void smx_fifo_item_set_enqueue_ts( smx_channel_t* ch, smx_fifo_item_t* item )
+{
+    if( ch->queue_hist == NULL )
+        return;
+
+    item->enqueue_ts = smx_get_time_ns();
+}
+
 /*****************************************************************************/
 smx_msg_t* smx_fifo_read( void* h, smx_channel_t* ch, smx_fifo_t* fifo )
 {
@@ -780,6 +1232,7 @@ smx_msg_t* smx_fifo_read( void* h, smx_channel_t* ch, smx_fifo_t* fifo )
         // messages are available
         msg = fifo->head->msg;
         fifo->head->msg = NULL;
+        smx_fifo_item_record_delay( ch, fifo->head );
         fifo->head = fifo->head->prev;
         fifo->count--;
         if( fifo->count == 0 )
@@ -820,6 +1273,7 @@ smx_msg_t* smx_fifo_d_read( void* h, smx_channel_t* ch, smx_fifo_t* fifo )
         // messages are available
         msg = fifo->head->msg;
         fifo->head->msg = NULL;
+        smx_fifo_item_record_delay( ch, fifo->head );
         fifo->head = fifo->head->prev;
         if( fifo->count == 1 && !msg->prevent_backup )
         {
@@ -842,8 +1296,9 @@ smx_msg_t* smx_fifo_d_read( void* h, smx_channel_t* ch, smx_fifo_t* fifo )
             msg = smx_msg_copy( h, fifo->backup );
             fifo->copy++;
 
-            SMX_LOG_CH( ch, info, "fifo_d is empty, duplicate backup" );
-            smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_DUPLICATE,
+            SMX_LOG_CH_ANOMALY( ch, ch->source, info,
+                    "fifo_d is empty, duplicate backup" );
+            SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_DUPLICATE,
                     0 );
         }
         else
@@ -872,6 +1327,7 @@ smx_msg_t* smx_fifo_dd_read( void* h, smx_channel_t* ch, smx_fifo_t* fifo )
         // messages are available
         msg = fifo->head->msg;
         fifo->head->msg = NULL;
+        smx_fifo_item_record_delay( ch, fifo->head );
         fifo->head = fifo->head->prev;
         fifo->count--;
         new_count = fifo->count;
@@ -897,6 +1353,7 @@ int smx_fifo_write( void* h, smx_channel_t* ch, smx_fifo_t* fifo,
     if(fifo->count < fifo->length)
     {
         fifo->tail->msg = msg;
+        smx_fifo_item_set_enqueue_ts( ch, fifo->tail );
         fifo->tail = fifo->tail->prev;
         fifo->count++;
         if( fifo->count == fifo->length )
@@ -934,21 +1391,19 @@ int smx_d_fifo_write( void* h, smx_channel_t* ch, smx_fifo_t* fifo,
     if( fifo->count < fifo->length )
     {
         fifo->tail->msg = msg;
+        smx_fifo_item_set_enqueue_ts( ch, fifo->tail );
         fifo->tail = fifo->tail->prev;
         fifo->count++;
         new_count = fifo->count;
-        if( fifo->overwrite > 1 )
+        if( fifo->overwrite > 1 && fifo->length > 1 )
         {
-            if( fifo->length > 1 )
-            {
-                SMX_LOG_CH( ch, notice, "tail of fifo was overwritten %d times",
-                        fifo->overwrite );
-            }
-            else
-            {
-                SMX_LOG_CH( ch, info, "tail of fifo was overwritten %d times",
-                        fifo->overwrite );
-            }
+            SMX_LOG_CH_ANOMALY( ch, ch->sink, notice,
+                    "tail of fifo was overwritten %d times", fifo->overwrite );
+        }
+        else if( fifo->overwrite > 1 )
+        {
+            SMX_LOG_CH_ANOMALY( ch, ch->sink, info,
+                    "tail of fifo was overwritten %d times", fifo->overwrite );
         }
         fifo->overwrite = 0;
 
@@ -961,21 +1416,20 @@ int smx_d_fifo_write( void* h, smx_channel_t* ch, smx_fifo_t* fifo,
     {
         msg_tmp = fifo->tail->msg;
         fifo->tail->msg = msg;
+        smx_fifo_item_set_enqueue_ts( ch, fifo->tail );
         fifo->overwrite++;
 
         smx_msg_destroy( h, msg_tmp, true );
-        if( fifo->overwrite == 1 )
+        if( fifo->overwrite == 1 && fifo->length > 1 )
         {
-            if( fifo->length > 1 )
-            {
-                SMX_LOG_CH( ch, notice, "overwrite tail of fifo" );
-            }
-            else
-            {
-                SMX_LOG_CH( ch, info, "overwrite tail of fifo" );
-            }
+            SMX_LOG_CH_ANOMALY( ch, ch->sink, notice,
+                    "overwrite tail of fifo" );
+        }
+        else if( fifo->overwrite == 1 )
+        {
+            SMX_LOG_CH_ANOMALY( ch, ch->sink, info, "overwrite tail of fifo" );
         }
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_OVERWRITE,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_OVERWRITE,
                 fifo->length );
     }
     return 0;
@@ -1094,7 +1548,7 @@ int smx_d_guard_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
     if( ( itval.it_value.tv_sec != 0 ) || ( itval.it_value.tv_nsec != 0 ) ) {
         SMX_LOG_CH( ch, info, "rate_control: discard message '%llu'",
                 msg->id );
-        smx_profiler_log_ch( h, ch, msg, SMX_PROFILER_ACTION_CH_DISMISS,
+        SMX_PROFILER_LOG_CH( h, ch, msg, SMX_PROFILER_ACTION_CH_DISMISS,
                 ch->fifo->count );
         smx_msg_destroy( h, msg, true );
         return 1;
@@ -1111,6 +1565,54 @@ int smx_d_guard_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
     return 0;
 }
 
+/*****************************************************************************/
+smx_msg_t* smx_rendezvous_read( void* h, smx_channel_t* ch )
+{
+    ( void )( h );
+    smx_msg_t* msg = NULL;
+    if( ch == NULL )
+        return NULL;
+
+    ch->source->err = SMX_CHANNEL_ERR_NONE;
+
+    if( ch->handoff != NULL )
+    {
+        msg = ch->handoff;
+        ch->handoff = NULL;
+        smx_channel_change_read_state( ch, SMX_CHANNEL_PENDING );
+        SMX_LOG_CH( ch, info, "read from rendezvous" );
+    }
+    else if( ch->source->state != SMX_CHANNEL_END )
+    {
+        SMX_LOG_CH( ch, error, "channel is ready but nothing was handed off" );
+        ch->source->err = SMX_CHANNEL_ERR_NO_DATA;
+    }
+    else
+        ch->source->err = SMX_CHANNEL_ERR_NO_TARGET;
+
+    return msg;
+}
+
+/*****************************************************************************/
+int smx_rendezvous_write( void* h, smx_channel_t* ch, smx_msg_t* msg )
+{
+    ( void )( h );
+    if( ch == NULL || msg == NULL )
+        return -1;
+
+    if( ch->handoff != NULL )
+    {
+        SMX_LOG_CH( ch, warn, "channel is ready but hand-off is pending" );
+        ch->sink->err = SMX_CHANNEL_ERR_NO_SPACE;
+        return -1;
+    }
+    ch->handoff = msg;
+    // the waiting consumer is claimed, the next producer has to wait again
+    smx_channel_change_write_state( ch, SMX_CHANNEL_PENDING );
+    SMX_LOG_CH( ch, info, "hand off to rendezvous" );
+    return 0;
+}
+
 /*****************************************************************************/
 int smx_set_read_timeout( smx_channel_t* ch, long sec, long nsec )
 {
@@ -147,6 +147,7 @@ int smx_config_data_maps_apply_ext( smx_config_data_maps_t* maps,
         SMX_LOG_NET( maps->h, debug, "apply maps in extendend mode" );
     }
 
+    smx_config_data_maps_resolve_src( maps, src_payload );
     bson_iter_init( &i_tgt, maps->tgt_payload );
     bson_destroy( &maps->mapped_payload );
     bson_init( &maps->mapped_payload );
@@ -214,6 +215,59 @@ int smx_config_data_maps_apply_ext_iter( bson_iter_t* i_tgt,
     return 0;
 }
 
+/*****************************************************************************/
+int smx_config_data_maps_apply_incremental( smx_config_data_maps_t* maps,
+        bson_t* src_payload )
+{
+    int i, rc, err = 0, count = 0;
+
+    if( maps == NULL )
+        return 0;
+
+    smx_config_data_maps_resolve_src( maps, src_payload );
+    for( i = 0; i < maps->count; i++ )
+    {
+        if( smx_config_data_map_update_src_value( &maps->items[i] ) )
+        {
+            count++;
+        }
+    }
+
+    if( maps->h )
+    {
+        SMX_LOG_NET( maps->h, debug, "%d of %d mapped source values changed",
+                count, maps->count );
+    }
+    if( count == 0 )
+    {
+        return 0;
+    }
+
+    if( maps->is_extended )
+    {
+        // the mapped payload is serialised and must be rebuilt
+        err = smx_config_data_maps_apply_ext( maps, src_payload );
+    }
+    else
+    {
+        for( i = 0; i < maps->count; i++ )
+        {
+            if( !maps->items[i].is_changed || maps->items[i].src_doc == NULL )
+            {
+                continue;
+            }
+            rc = smx_config_data_maps_apply_base( &maps->items[i],
+                    maps->items[i].src_doc );
+            if( rc < 0 )
+            {
+                err = rc;
+            }
+        }
+    }
+
+    return ( err < 0 ) ? err : count;
+}
+
 /******************************************************************************/
 void smx_config_data_maps_cleanup( smx_config_data_maps_t* maps )
 {
@@ -227,7 +281,13 @@ void smx_config_data_maps_cleanup( smx_config_data_maps_t* maps )
         {
             bson_destroy( maps->items[i].src_payload );
         }
+        if( maps->items[i].is_src_value_set )
+        {
+            bson_value_destroy( &maps->items[i].src_value );
+        }
     }
+    smx_hmap_destroy( maps->tgt_index, NULL );
+    free( maps->items );
     bson_destroy( &maps->mapped_payload );
     free( maps );
 }
@@ -260,33 +320,63 @@ smx_config_data_map_t* smx_config_data_maps_get_map_by_key(
     return NULL;
 }
 
+/******************************************************************************/
+int smx_config_data_maps_grow( smx_config_data_maps_t* maps, int size )
+{
+    smx_config_data_map_t* items;
+
+    if( size <= maps->size )
+    {
+        return 0;
+    }
+    items = realloc( maps->items, sizeof( smx_config_data_map_t ) * size );
+    if( items == NULL )
+    {
+        return -1;
+    }
+    maps->items = items;
+    maps->size = size;
+
+    if( maps->tgt_index != NULL )
+    {
+        // the index points to the moved items
+        smx_hmap_destroy( maps->tgt_index, NULL );
+        return smx_config_data_maps_init_tgt_index( maps );
+    }
+
+    return 0;
+}
+
 /******************************************************************************/
 int smx_config_data_maps_init( bson_iter_t* i_fields, bson_t* data,
         smx_config_data_maps_t* maps )
 {
-    int rc, i;
+    int rc, count = 0;
     maps->h = NULL;
+    maps->items = NULL;
     maps->count = 0;
+    maps->size = 0;
     maps->is_extended = false;
+    maps->tgt_index = NULL;
     maps->tgt_payload = data;
     bson_copy_to( data, &maps->mapped_payload );
     bson_iter_t i_field;
+    bson_iter_t i_count = *i_fields;
 
-    for( i = 0; i < SMX_CONFIG_MAX_MAP_ITEMS; i++ )
+    // size the map set to the number of maps
+    while( bson_iter_next( &i_count ) )
     {
-        maps->items[i].is_src_iter_set = false;
-        maps->items[i].key = NULL;
-        maps->items[i].src_path = NULL;
-        maps->items[i].src_prefix = NULL;
-        maps->items[i].tgt_path = NULL;
-        maps->items[i].src_payload = NULL;
-        maps->items[i].type = BSON_TYPE_UNDEFINED;
-        maps->items[i].h = NULL;
+        count++;
+    }
+    if( smx_config_data_maps_grow( maps, count ) < 0 )
+    {
+        return SMX_CONFIG_MAP_ERROR_MAP_COUNT_EXCEEDED;
     }
 
     while( bson_iter_next( i_fields ) )
     {
-        if( maps->count >= SMX_CONFIG_MAX_MAP_ITEMS )
+        if( maps->count >= maps->size
+                && smx_config_data_maps_grow( maps, 2 * maps->size ) < 0 )
         {
             return SMX_CONFIG_MAP_ERROR_MAP_COUNT_EXCEEDED;
         }
@@ -311,6 +401,33 @@ int smx_config_data_maps_init( bson_iter_t* i_fields, bson_t* data,
         return SMX_CONFIG_MAP_ERROR_NO_MAP_ITEM;
     }
 
+    return smx_config_data_maps_init_tgt_index( maps );
+}
+
+/******************************************************************************/
+int smx_config_data_maps_init_tgt_index( smx_config_data_maps_t* maps )
+{
+    int i;
+
+    maps->tgt_index = smx_hmap_create( 2 * maps->count );
+    if( maps->tgt_index == NULL )
+    {
+        return SMX_CONFIG_MAP_ERROR_TGT_INDEX;
+    }
+    for( i = 0; i < maps->count; i++ )
+    {
+        // the first map of a target path takes precedence
+        if( smx_hmap_get( maps->tgt_index, maps->items[i].tgt_path ) != NULL )
+        {
+            continue;
+        }
+        if( smx_hmap_set( maps->tgt_index, maps->items[i].tgt_path,
+                    &maps->items[i] ) < 0 )
+        {
+            return SMX_CONFIG_MAP_ERROR_TGT_INDEX;
+        }
+    }
+
     return 0;
 }
 
@@ -327,154 +444,183 @@ void smx_config_data_maps_init_net_handler( smx_config_data_maps_t* maps,
     }
 }
 
+/******************************************************************************/
+bool smx_config_data_maps_is_changed( smx_config_data_maps_t* maps,
+        const char* key )
+{
+    smx_config_data_map_t* map;
+
+    if( maps == NULL )
+        return false;
+
+    map = smx_config_data_maps_get_map_by_key( maps, key );
+    return map != NULL && map->is_changed;
+}
+
+/******************************************************************************/
+void smx_config_data_maps_resolve_src( smx_config_data_maps_t* maps,
+        bson_t* src_payload )
+{
+    int i;
+    char src_path[256];
+    const char* src_path_ptr;
+    smx_config_data_map_t* map;
+    bson_t* src_payload_item = src_payload;
+
+    for( i = 0; i < maps->count; i++ )
+    {
+        map = &maps->items[i];
+        if( map->src_payload != NULL )
+        {
+            src_payload_item = map->src_payload;
+        }
+        map->src_doc = src_payload_item;
+        map->is_src_iter_set = false;
+        if( src_payload_item == NULL || map->src_path == NULL
+                || strcmp( map->src_path, "." ) == 0 )
+        {
+            continue;
+        }
+
+        src_path_ptr = map->src_path;
+        if( map->src_prefix != NULL )
+        {
+            sprintf( src_path, "%s%s", map->src_prefix, map->src_path );
+            src_path_ptr = src_path;
+        }
+        map->is_src_iter_set = smx_config_data_map_get_iter( src_payload_item,
+                src_path_ptr, &map->src_iter );
+    }
+}
+
 /*****************************************************************************/
 int smx_config_data_map_append_val( const char* dot_key,
         const char* iter_key, bson_t* src_payload, bson_t* payload,
         smx_config_data_maps_t* maps )
 {
-    int i;
     const bson_oid_t* oid;
     bson_oid_t oid_init;
     char oid_str[25];
-    bson_t* src_payload_item = src_payload;
     bson_iter_t* src_child;
-    char src_path[256];
-    const char* src_path_ptr;
     uint32_t data_len;
     const uint8_t* data_doc;
     bson_t doc;
+    smx_config_data_map_t* map;
 
-    for( i = 0; i < maps->count; i++ )
+    // the source payloads are resolved by smx_config_data_maps_resolve_src()
+    ( void )src_payload;
+
+    map = smx_hmap_get( maps->tgt_index, dot_key );
+    if( map == NULL )
     {
-        if( maps->items[i].src_payload != NULL )
+        return SMX_CONFIG_MAP_ERROR_MISSING_TGT_KEY;
+    }
+    if( map->src_doc == NULL || map->src_path == NULL )
+    {
+        if( maps->h )
         {
-            src_payload_item = maps->items[i].src_payload;
+            SMX_LOG_NET( maps->h, warn, "no src payload or src path"
+                    " defined, ignoring map at '%s'", dot_key );
         }
-        if( src_payload_item == NULL || maps->items[i].src_path == NULL )
+        return SMX_CONFIG_MAP_ERROR_MISSING_TGT_KEY;
+    }
+    if( strcmp( map->src_path, "." ) == 0 )
+    {
+        BSON_APPEND_DOCUMENT( payload, iter_key, map->src_doc );
+        return 0;
+    }
+    if( !map->is_src_iter_set )
+    {
+        return SMX_CONFIG_MAP_ERROR_MISSING_SRC_KEY;
+    }
+
+    src_child = &map->src_iter;
+    if( map->type == BSON_TYPE_UNDEFINED )
+    {
+        BSON_APPEND_VALUE( payload, iter_key,
+                bson_iter_value( src_child ) );
+    }
+    else if( map->type == BSON_TYPE_UTF8 )
+    {
+        if( BSON_ITER_HOLDS_OID( src_child ) )
         {
-            if( maps->h )
-            {
-                SMX_LOG_NET( maps->h, warn, "no src payload or src path"
-                        " defined, ignoring map %d at '%s'", i, dot_key );
-            }
-            continue;
+            oid = bson_iter_oid( src_child );
+            bson_oid_to_string( oid, oid_str );
+            BSON_APPEND_UTF8( payload, iter_key, oid_str );
         }
-        if( strcmp( dot_key, maps->items[i].tgt_path ) == 0 )
+        else if( BSON_ITER_HOLDS_UTF8( src_child ) )
         {
-            if( strcmp( maps->items[i].src_path, "." ) == 0 )
-            {
-                BSON_APPEND_DOCUMENT( payload, iter_key, src_payload_item );
-                return 0;
-            }
-
-            src_path_ptr = maps->items[i].src_path;
-            if( maps->items[i].src_prefix != NULL )
-            {
-                sprintf( src_path, "%s%s", maps->items[i].src_prefix,
-                        maps->items[i].src_path );
-                src_path_ptr = src_path;
-            }
-
-            if( smx_config_data_map_get_iter( src_payload_item, src_path_ptr,
-                        &maps->items[i].src_iter ) )
-            {
-                maps->items[i].is_src_iter_set = true;
-                src_child = &maps->items[i].src_iter;
-                if( maps->items[i].type == BSON_TYPE_UNDEFINED )
-                {
-                    BSON_APPEND_VALUE( payload, iter_key,
-                            bson_iter_value( src_child ) );
-                }
-                else if( maps->items[i].type == BSON_TYPE_UTF8 )
-                {
-                    if( BSON_ITER_HOLDS_OID( src_child ) )
-                    {
-                        oid = bson_iter_oid( src_child );
-                        bson_oid_to_string( oid, oid_str );
-                        BSON_APPEND_UTF8( payload, iter_key, oid_str );
-                    }
-                    else if( BSON_ITER_HOLDS_UTF8( src_child ) )
-                    {
-                        BSON_APPEND_UTF8( payload, iter_key,
-                                bson_iter_utf8( src_child, NULL ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_OID )
-                {
-                    if( BSON_ITER_HOLDS_UTF8( src_child ) )
-                    {
-                        bson_oid_init_from_string( &oid_init,
-                                bson_iter_utf8( src_child, NULL ) );
-                        BSON_APPEND_OID( payload, iter_key, &oid_init );
-                    }
-                    else if( BSON_ITER_HOLDS_OID( src_child ) )
-                    {
-                        BSON_APPEND_OID( payload, iter_key,
-                                bson_iter_oid( src_child ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_INT32 )
-                {
-                    if( smx_config_data_map_can_write_int32( src_child ) )
-                    {
-                        BSON_APPEND_INT32( payload, iter_key,
-                                bson_iter_int32( src_child ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_INT64 )
-                {
-                    if( smx_config_data_map_can_write_int64( src_child ) )
-                    {
-                        BSON_APPEND_INT64( payload, iter_key,
-                                bson_iter_as_int64( src_child ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_DOUBLE )
-                {
-                    if( smx_config_data_map_can_write_double( src_child ) )
-                    {
-                        BSON_APPEND_DOUBLE( payload, iter_key,
-                                bson_iter_as_double( src_child ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_BOOL )
-                {
-                    if( smx_config_data_map_can_write_bool( src_child ) )
-                    {
-                        BSON_APPEND_BOOL( payload, iter_key,
-                                bson_iter_as_bool( src_child ) );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_ARRAY )
-                {
-                    if( BSON_ITER_HOLDS_ARRAY( src_child ) )
-                    {
-                        bson_iter_array( src_child, &data_len, &data_doc );
-                        bson_init_static( &doc, data_doc, data_len );
-                        BSON_APPEND_ARRAY( payload, iter_key, &doc );
-                        bson_destroy( &doc );
-                    }
-                }
-                else if( maps->items[i].type == BSON_TYPE_DOCUMENT )
-                {
-                    if( BSON_ITER_HOLDS_DOCUMENT( src_child ) )
-                    {
-                        bson_iter_document( src_child, &data_len, &data_doc );
-                        bson_init_static( &doc, data_doc, data_len );
-                        BSON_APPEND_DOCUMENT( payload, iter_key, &doc );
-                        bson_destroy( &doc );
-                    }
-                }
-                return 0;
-            }
-            else
-            {
-                return SMX_CONFIG_MAP_ERROR_MISSING_SRC_KEY;
-            }
+            BSON_APPEND_UTF8( payload, iter_key,
+                    bson_iter_utf8( src_child, NULL ) );
         }
     }
-
-    return SMX_CONFIG_MAP_ERROR_MISSING_TGT_KEY;
+    else if( map->type == BSON_TYPE_OID )
+    {
+        if( BSON_ITER_HOLDS_UTF8( src_child ) )
+        {
+            bson_oid_init_from_string( &oid_init,
+                    bson_iter_utf8( src_child, NULL ) );
+            BSON_APPEND_OID( payload, iter_key, &oid_init );
+        }
+        else if( BSON_ITER_HOLDS_OID( src_child ) )
+        {
+            BSON_APPEND_OID( payload, iter_key,
+                    bson_iter_oid( src_child ) );
+        }
+    }
+    else if( map->type == BSON_TYPE_INT32 )
+    {
+        if( smx_config_data_map_can_write_int32( src_child ) )
+        {
+            BSON_APPEND_INT32( payload, iter_key,
+                    bson_iter_int32( src_child ) );
+        }
+    }
+    else if( map->type == BSON_TYPE_INT64 )
+    {
+        if( smx_config_data_map_can_write_int64( src_child ) )
+        {
+            BSON_APPEND_INT64( payload, iter_key,
+                    bson_iter_as_int64( src_child ) );
+        }
+    }
+    else if( map->type == BSON_TYPE_DOUBLE )
+    {
+        if( smx_config_data_map_can_write_double( src_child ) )
+        {
+            BSON_APPEND_DOUBLE( payload, iter_key,
+                    bson_iter_as_double( src_child ) );
+        }
+    }
+    else if( map->type == BSON_TYPE_BOOL )
+    {
+        if( smx_config_data_map_can_write_bool( src_child ) )
+        {
+            BSON_APPEND_BOOL( payload, iter_key,
+                    bson_iter_as_bool( src_child ) );
+        }
+    }
+    else if( map->type == BSON_TYPE_ARRAY )
+    {
+        if( BSON_ITER_HOLDS_ARRAY( src_child ) )
+        {
+            bson_iter_array( src_child, &data_len, &data_doc );
+            bson_init_static( &doc, data_doc, data_len );
+            BSON_APPEND_ARRAY( payload, iter_key, &doc );
+            bson_destroy( &doc );
+        }
+    }
+    else if( map->type == BSON_TYPE_DOCUMENT )
+    {
+        if( BSON_ITER_HOLDS_DOCUMENT( src_child ) )
+        {
+            bson_iter_document( src_child, &data_len, &data_doc );
+            bson_init_static( &doc, data_doc, data_len );
+            BSON_APPEND_DOCUMENT( payload, iter_key, &doc );
+            bson_destroy( &doc );
+        }
+    }
+    return 0;
 }
 
 /******************************************************************************/
@@ -567,6 +713,9 @@ int smx_config_data_map_init( bson_t* payload,
     map->src_prefix = NULL;
     map->tgt_path = NULL;
     map->src_payload = NULL;
+    map->src_doc = NULL;
+    map->is_src_value_set = false;
+    map->is_changed = false;
     map->type = BSON_TYPE_UNDEFINED;
     map->h = NULL;
 
@@ -755,6 +904,47 @@ int smx_config_data_map_init_tgt_utf8( bson_t* data,
     return 0;
 }
 
+/******************************************************************************/
+bool smx_config_data_map_is_value_equal( const bson_value_t* a,
+        const bson_value_t* b )
+{
+    if( a->value_type != b->value_type )
+    {
+        return false;
+    }
+
+    switch( a->value_type )
+    {
+        case BSON_TYPE_BOOL:
+            return a->value.v_bool == b->value.v_bool;
+        case BSON_TYPE_INT32:
+            return a->value.v_int32 == b->value.v_int32;
+        case BSON_TYPE_INT64:
+            return a->value.v_int64 == b->value.v_int64;
+        case BSON_TYPE_DOUBLE:
+            // compare bitwise such that NaN values are stable
+            return memcmp( &a->value.v_double, &b->value.v_double,
+                    sizeof( double ) ) == 0;
+        case BSON_TYPE_UTF8:
+            return a->value.v_utf8.len == b->value.v_utf8.len
+                && memcmp( a->value.v_utf8.str, b->value.v_utf8.str,
+                        a->value.v_utf8.len ) == 0;
+        case BSON_TYPE_OID:
+            return bson_oid_equal( &a->value.v_oid, &b->value.v_oid );
+        case BSON_TYPE_DOCUMENT:
+        case BSON_TYPE_ARRAY:
+            return a->value.v_doc.data_len == b->value.v_doc.data_len
+                && memcmp( a->value.v_doc.data, b->value.v_doc.data,
+                        a->value.v_doc.data_len ) == 0;
+        case BSON_TYPE_NULL:
+        case BSON_TYPE_UNDEFINED:
+            return true;
+        default:
+            // unsupported types are always considered as changed
+            return false;
+    }
+}
+
 /******************************************************************************/
 const char* smx_config_data_map_strerror( int code )
 {
@@ -776,7 +966,7 @@ const char* smx_config_data_map_strerror( int code )
         case SMX_CONFIG_MAP_ERROR_MISSING_TGT_DEF:
             return "missing target path definition in key map value";
         case SMX_CONFIG_MAP_ERROR_MAP_COUNT_EXCEEDED:
-            return "number of allowed key mappings exceeded";
+            return "failed to allocate the key mappings";
         case SMX_CONFIG_MAP_ERROR_BAD_MAP_TYPE:
             return "a key mapping in config item `map` must be an object";
         case SMX_CONFIG_MAP_ERROR_NO_MAP_ITEM:
@@ -784,6 +974,8 @@ const char* smx_config_data_map_strerror( int code )
                 " data map";
         case SMX_CONFIG_MAP_ERROR_BAD_TYPE_OPTION:
             return "undefined type option in key map value";
+        case SMX_CONFIG_MAP_ERROR_TGT_INDEX:
+            return "failed to build the target path index";
         default:
             return undefined;
     }
@@ -791,6 +983,52 @@ const char* smx_config_data_map_strerror( int code )
     return undefined;
 }
 
+/******************************************************************************/
+bool smx_config_data_map_update_src_value( smx_config_data_map_t* map )
+{
+    bson_value_t root;
+    const bson_value_t* value = NULL;
+
+    if( map->src_doc != NULL && map->src_path != NULL
+            && strcmp( map->src_path, "." ) == 0 )
+    {
+        root.value_type = BSON_TYPE_DOCUMENT;
+        root.value.v_doc.data = ( uint8_t* )bson_get_data( map->src_doc );
+        root.value.v_doc.data_len = map->src_doc->len;
+        value = &root;
+    }
+    else if( map->is_src_iter_set )
+    {
+        value = bson_iter_value( &map->src_iter );
+    }
+
+    if( value == NULL )
+    {
+        // a removed source value resets the target to its fallback
+        map->is_changed = map->is_src_value_set;
+    }
+    else
+    {
+        map->is_changed = !map->is_src_value_set
+            || !smx_config_data_map_is_value_equal( &map->src_value, value );
+    }
+
+    if( map->is_changed )
+    {
+        if( map->is_src_value_set )
+        {
+            bson_value_destroy( &map->src_value );
+        }
+        map->is_src_value_set = ( value != NULL );
+        if( value != NULL )
+        {
+            bson_value_copy( value, &map->src_value );
+        }
+    }
+
+    return map->is_changed;
+}
+
 /*****************************************************************************/
 bool smx_config_get_bool( bson_t* conf, const char* search )
 {
@@ -903,6 +1141,128 @@ const char* smx_config_get_string_err( bson_t* conf, const char* search,
     return NULL;
 }
 
+/*****************************************************************************/
+smx_config_handle_t* smx_config_handle_create( void* h, const char* search,
+        bson_type_t type )
+{
+    smx_config_handle_t* handle;
+
+    if( h == NULL || search == NULL )
+        return NULL;
+
+    handle = smx_malloc( sizeof( struct smx_config_handle_s ) );
+    if( handle == NULL )
+        return NULL;
+
+    handle->search = strdup( search );
+    if( handle->search == NULL )
+    {
+        free( handle );
+        return NULL;
+    }
+    handle->h = h;
+    handle->type = type;
+    handle->is_resolved = false;
+    handle->conf_version = 0;
+    handle->err = SMX_CONFIG_ERROR_NO_VALUE;
+    handle->len = 0;
+    memset( &handle->val, 0, sizeof( handle->val ) );
+    return handle;
+}
+
+/*****************************************************************************/
+void smx_config_handle_destroy( smx_config_handle_t* handle )
+{
+    if( handle == NULL )
+        return;
+
+    free( handle->search );
+    free( handle );
+}
+
+/*****************************************************************************/
+bool smx_config_handle_get_bool( smx_config_handle_t* handle )
+{
+    smx_config_handle_resolve( handle );
+    return handle->val.v_bool;
+}
+
+/*****************************************************************************/
+double smx_config_handle_get_double( smx_config_handle_t* handle )
+{
+    smx_config_handle_resolve( handle );
+    return handle->val.v_double;
+}
+
+/*****************************************************************************/
+smx_config_error_t smx_config_handle_get_error( smx_config_handle_t* handle )
+{
+    smx_config_handle_resolve( handle );
+    return handle->err;
+}
+
+/*****************************************************************************/
+int smx_config_handle_get_int( smx_config_handle_t* handle )
+{
+    smx_config_handle_resolve( handle );
+    return handle->val.v_int32;
+}
+
+/*****************************************************************************/
+const char* smx_config_handle_get_string( smx_config_handle_t* handle,
+        unsigned int* len )
+{
+    smx_config_handle_resolve( handle );
+    if( len != NULL )
+        *len = handle->len;
+    return handle->val.v_utf8;
+}
+
+/*****************************************************************************/
+void smx_config_handle_resolve( smx_config_handle_t* handle )
+{
+    smx_net_t* h = handle->h;
+    bson_t* conf = h->conf;
+
+    if( handle->is_resolved && handle->conf_version == h->conf_version )
+        return;
+
+    memset( &handle->val, 0, sizeof( handle->val ) );
+    handle->len = 0;
+    handle->err = SMX_CONFIG_ERROR_NO_VALUE;
+    switch( conf == NULL ? BSON_TYPE_EOD : handle->type )
+    {
+        case BSON_TYPE_BOOL:
+            handle->val.v_bool = smx_config_get_bool_err( conf,
+                    handle->search, &handle->err );
+            break;
+        case BSON_TYPE_INT32:
+            handle->val.v_int32 = smx_config_get_int_err( conf,
+                    handle->search, &handle->err );
+            break;
+        case BSON_TYPE_DOUBLE:
+            handle->val.v_double = smx_config_get_double_err( conf,
+                    handle->search, &handle->err );
+            break;
+        case BSON_TYPE_UTF8:
+            handle->val.v_utf8 = smx_config_get_string_err( conf,
+                    handle->search, &handle->len, &handle->err );
+            break;
+        case BSON_TYPE_EOD:
+            // no net configuration available
+            break;
+        default:
+            handle->err = SMX_CONFIG_ERROR_BAD_TYPE;
+    }
+    if( handle->err != SMX_CONFIG_ERROR_NO_ERROR )
+    {
+        SMX_LOG_NET( h, debug, "config handle '%s': %s", handle->search,
+                smx_config_strerror( handle->err ) );
+    }
+    handle->conf_version = h->conf_version;
+    handle->is_resolved = true;
+}
+
 /*****************************************************************************/
 int smx_config_init_bool( bson_t* conf, const char* search, bool* val )
 {
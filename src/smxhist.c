@@ -0,0 +1,141 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Latency histograms for the runtime system library of Streamix
+ */
+
+#include <string.h>
+#include "smxhist.h"
+#include "smxlog.h"
+#include "smxutils.h"
+
+/*****************************************************************************/
+smx_hist_t* smx_hist_create()
+{
+    smx_hist_t* hist = smx_malloc( sizeof( struct smx_hist_s ) );
+    if( hist == NULL )
+        return NULL;
+
+    smx_hist_reset( hist );
+    return hist;
+}
+
+/*****************************************************************************/
+void smx_hist_destroy( smx_hist_t* hist )
+{
+    if( hist == NULL )
+        return;
+
+    free( hist );
+}
+
+/*****************************************************************************/
+int smx_hist_get_bucket_idx( uint64_t val )
+{
+    int shift;
+
+    if( val < 2 * SMX_HIST_SUB_COUNT )
+        return val;
+
+    shift = 63 - __builtin_clzll( val ) - SMX_HIST_SUB_BITS;
+    return ( shift + 1 ) * SMX_HIST_SUB_COUNT
+        + ( val >> shift ) - SMX_HIST_SUB_COUNT;
+}
+
+/*****************************************************************************/
+uint64_t smx_hist_get_bucket_max( int idx )
+{
+    int shift;
+    uint64_t sub;
+
+    if( idx < 2 * SMX_HIST_SUB_COUNT )
+        return idx;
+
+    shift = idx / SMX_HIST_SUB_COUNT - 1;
+    sub = idx % SMX_HIST_SUB_COUNT + SMX_HIST_SUB_COUNT;
+    return ( ( sub + 1 ) << shift ) - 1;
+}
+
+/*****************************************************************************/
+double smx_hist_get_mean( smx_hist_t* hist )
+{
+    uint64_t count = __atomic_load_n( &hist->count, __ATOMIC_RELAXED );
+
+    if( count == 0 )
+        return 0;
+
+    return ( double )__atomic_load_n( &hist->sum, __ATOMIC_RELAXED ) / count;
+}
+
+/*****************************************************************************/
+uint64_t smx_hist_get_percentile( smx_hist_t* hist, double percentile )
+{
+    int i;
+    uint64_t seen = 0;
+    uint64_t target;
+    uint64_t count = __atomic_load_n( &hist->count, __ATOMIC_RELAXED );
+    uint64_t max = __atomic_load_n( &hist->max, __ATOMIC_RELAXED );
+
+    if( count == 0 )
+        return 0;
+
+    target = ( uint64_t )( percentile / 100.0 * count + 0.5 );
+    if( target < 1 )
+        target = 1;
+    for( i = 0; i < SMX_HIST_BUCKETS; i++ )
+    {
+        seen += __atomic_load_n( &hist->buckets[i], __ATOMIC_RELAXED );
+        if( seen >= target )
+            return SMX_MIN( smx_hist_get_bucket_max( i ), max );
+    }
+    return max;
+}
+
+/*****************************************************************************/
+void smx_hist_log( smx_hist_t* hist, zlog_category_t* cat, const char* name )
+{
+    if( hist == NULL )
+        return;
+
+    SMX_LOG_INTERN( notice, cat, "%s [ns]: count: %lu, mean: %.0f, p50: %lu,"
+            " p99: %lu, p99.9: %lu, max: %lu", name,
+            __atomic_load_n( &hist->count, __ATOMIC_RELAXED ),
+            smx_hist_get_mean( hist ),
+            smx_hist_get_percentile( hist, 50 ),
+            smx_hist_get_percentile( hist, 99 ),
+            smx_hist_get_percentile( hist, 99.9 ),
+            __atomic_load_n( &hist->max, __ATOMIC_RELAXED ) );
+}
+
+/*****************************************************************************/
+void smx_hist_record( smx_hist_t* hist, uint64_t val )
+{
+    uint64_t* bucket;
+
+    if( hist == NULL )
+        return;
+
+    // single writer: plain read-modify-write without a locked instruction
+    bucket = &hist->buckets[smx_hist_get_bucket_idx( val )];
+    __atomic_store_n( bucket, *bucket + 1, __ATOMIC_RELAXED );
+    __atomic_store_n( &hist->sum, hist->sum + val, __ATOMIC_RELAXED );
+    if( val < hist->min )
+        __atomic_store_n( &hist->min, val, __ATOMIC_RELAXED );
+    if( val > hist->max )
+        __atomic_store_n( &hist->max, val, __ATOMIC_RELAXED );
+    __atomic_store_n( &hist->count, hist->count + 1, __ATOMIC_RELAXED );
+}
+
+/*****************************************************************************/
+void smx_hist_reset( smx_hist_t* hist )
+{
+    memset( hist->buckets, 0, sizeof( hist->buckets ) );
+    hist->count = 0;
+    hist->sum = 0;
+    hist->min = UINT64_MAX;
+    hist->max = 0;
+}
@@ -8,8 +8,12 @@
  * Log definitions for the runtime system library of Streamix
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include "smxlog.h"
+#include "smxutils.h"
 
 zlog_category_t* smx_zcat_ch;
 zlog_category_t* smx_zcat_net;
@@ -17,15 +21,17 @@ zlog_category_t* smx_zcat_main;
 zlog_category_t* smx_zcat_msg;
 pthread_mutex_t mlog;
 
+// the asynchronous log backend
+pthread_mutex_t mlog_ring = PTHREAD_MUTEX_INITIALIZER;
+smx_log_ring_t* smx_log_rings = NULL;
+bool smx_log_is_running = false;
+pthread_t smx_log_th;
+__thread smx_log_ring_t* smx_log_thread_ring = NULL;
+
 /*****************************************************************************/
 int smx_log_init( const char* log_conf )
 {
-    pthread_mutexattr_t mutexattr_prioinherit;
-
-    pthread_mutexattr_init( &mutexattr_prioinherit );
-    pthread_mutexattr_setprotocol( &mutexattr_prioinherit,
-            PTHREAD_PRIO_INHERIT );
-    pthread_mutex_init( &mlog, &mutexattr_prioinherit );
+    smx_mutex_init( &mlog, true );
 
     int rc = zlog_init( log_conf );
 
@@ -41,15 +47,84 @@ int smx_log_init( const char* log_conf )
     smx_zcat_ch = zlog_get_category( "ch" );
     smx_zcat_net = zlog_get_category( "net" );
 
+#ifdef SMX_LOG_ASYNC
+    if( smx_log_ring_start() < 0 )
+        fprintf( stderr, "error: failed to start log thread, log"
+                " synchronously\n" );
+#endif
+
     return 0;
 }
 
 /*****************************************************************************/
 void smx_log_cleanup()
 {
+    smx_log_ring_stop();
     zlog_fini();
 }
 
+/*****************************************************************************/
+smx_log_arg_t smx_log_arg_double( long double val )
+{
+    smx_log_arg_t arg;
+    arg.type = SMX_LOG_ARG_DOUBLE;
+    arg.d = val;
+    return arg;
+}
+
+/*****************************************************************************/
+smx_log_arg_t smx_log_arg_int( long long val )
+{
+    smx_log_arg_t arg;
+    arg.type = SMX_LOG_ARG_INT;
+    arg.i = val;
+    return arg;
+}
+
+/*****************************************************************************/
+smx_log_arg_t smx_log_arg_ptr( const void* val )
+{
+    smx_log_arg_t arg;
+    arg.type = SMX_LOG_ARG_PTR;
+    arg.p = val;
+    return arg;
+}
+
+/*****************************************************************************/
+smx_log_arg_t smx_log_arg_str( const char* val )
+{
+    smx_log_arg_t arg;
+    arg.type = SMX_LOG_ARG_STR;
+    arg.s = ( val == NULL ) ? "(null)" : val;
+    return arg;
+}
+
+/*****************************************************************************/
+int smx_log_get_level( zlog_category_t* cat )
+{
+    int i;
+    const int levels[] = { ZLOG_LEVEL_DEBUG, ZLOG_LEVEL_INFO,
+        ZLOG_LEVEL_EVENT, ZLOG_LEVEL_NOTICE, ZLOG_LEVEL_WARN, ZLOG_LEVEL_ERROR,
+        ZLOG_LEVEL_FATAL };
+
+    if( cat == NULL )
+        return ZLOG_LEVEL_FATAL + 1;
+
+    for( i = 0; i < ( int )( sizeof( levels ) / sizeof( int ) ); i++ )
+    {
+        if( zlog_level_enabled( cat, levels[i] ) )
+            return levels[i];
+    }
+    return ZLOG_LEVEL_FATAL + 1;
+}
+
+/*****************************************************************************/
+void smx_log_init_mutex( bool is_prio_inherit )
+{
+    pthread_mutex_destroy( &mlog );
+    smx_mutex_init( &mlog, is_prio_inherit );
+}
+
 /*****************************************************************************/
 pthread_mutex_t* smx_get_mlog() { return &mlog; }
 
@@ -64,3 +139,307 @@ zlog_category_t* smx_get_zcat_msg() { return smx_zcat_msg; }
 
 /*****************************************************************************/
 zlog_category_t* smx_get_zcat_net() { return smx_zcat_net; }
+
+/*****************************************************************************/
+smx_log_ring_t* smx_log_ring_create( int size )
+{
+    uint64_t len = 1;
+    smx_log_ring_t* ring;
+
+    while( len < ( uint64_t )size )
+        len <<= 1;
+
+    if( posix_memalign( ( void** )&ring, 64,
+                sizeof( struct smx_log_ring_s ) ) != 0 )
+        return NULL;
+    ring->records = malloc( len * sizeof( struct smx_log_record_s ) );
+    if( ring->records == NULL )
+    {
+        free( ring );
+        return NULL;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    ring->drop_count = 0;
+    ring->drop_report = 0;
+    ring->mask = len - 1;
+
+    // rings are only prepended such that the log thread can walk the list
+    pthread_mutex_lock( &mlog_ring );
+    ring->next = smx_log_rings;
+    __atomic_store_n( &smx_log_rings, ring, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &mlog_ring );
+    return ring;
+}
+
+/*****************************************************************************/
+void smx_log_ring_destroy( smx_log_ring_t* ring )
+{
+    if( ring == NULL )
+        return;
+
+    free( ring->records );
+    free( ring );
+}
+
+/*****************************************************************************/
+void smx_log_ring_emit( smx_log_record_t* record )
+{
+    char line[SMX_LOG_RING_LINE_LEN];
+
+    smx_log_ring_format( record, line, sizeof( line ) );
+    zlog( record->cat, record->file, strlen( record->file ), record->func,
+            strlen( record->func ), record->line, record->level, "%s", line );
+}
+
+/*****************************************************************************/
+void smx_log_ring_flush()
+{
+    uint64_t head;
+    uint64_t drop_count;
+    smx_log_ring_t* ring;
+
+    ring = __atomic_load_n( &smx_log_rings, __ATOMIC_ACQUIRE );
+    while( ring != NULL )
+    {
+        head = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+        while( ring->tail < head )
+        {
+            smx_log_ring_emit( &ring->records[ring->tail & ring->mask] );
+            __atomic_store_n( &ring->tail, ring->tail + 1, __ATOMIC_RELEASE );
+        }
+        drop_count = __atomic_load_n( &ring->drop_count, __ATOMIC_RELAXED );
+        if( drop_count > ring->drop_report )
+        {
+            zlog_warn( smx_zcat_main, "log ring full, dropped %lu records",
+                    drop_count - ring->drop_report );
+            ring->drop_report = drop_count;
+        }
+        ring = ring->next;
+    }
+}
+
+/*****************************************************************************/
+int smx_log_ring_format( smx_log_record_t* record, char* buf, size_t len )
+{
+    char spec[32];
+    char conv;
+    char mod;
+    const char* f = record->format;
+    size_t spec_len;
+    size_t pos = 0;
+    int idx = 0;
+    int n = 0;
+    long long i;
+    smx_log_arg_t* arg;
+
+    while( *f != '\0' && pos + 1 < len )
+    {
+        if( *f != '%' )
+        {
+            buf[pos++] = *f++;
+            continue;
+        }
+        if( f[1] == '%' )
+        {
+            buf[pos++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // the specification including '%' and the conversion character
+        spec_len = strcspn( f + 1, "diouxXcfFeEgGaAsp" ) + 2;
+        if( f[spec_len - 1] == '\0' || spec_len >= sizeof( spec )
+                || idx >= record->arg_count )
+            break;
+        memcpy( spec, f, spec_len );
+        spec[spec_len] = '\0';
+        f += spec_len;
+        conv = spec[spec_len - 1];
+        mod = ( spec_len > 2 ) ? spec[spec_len - 2] : '\0';
+        arg = &record->args[idx++];
+        i = arg->i;
+
+        switch( conv )
+        {
+            case 'd':
+            case 'i':
+                if( mod == 'l' && spec_len > 3 && spec[spec_len - 3] == 'l' )
+                    n = snprintf( buf + pos, len - pos, spec, i );
+                else if( mod == 'l' || mod == 'z' || mod == 'j'
+                        || mod == 't' )
+                    n = snprintf( buf + pos, len - pos, spec, ( long )i );
+                else
+                    n = snprintf( buf + pos, len - pos, spec, ( int )i );
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                if( mod == 'l' && spec_len > 3 && spec[spec_len - 3] == 'l' )
+                    n = snprintf( buf + pos, len - pos, spec,
+                            ( unsigned long long )i );
+                else if( mod == 'l' || mod == 'z' || mod == 'j'
+                        || mod == 't' )
+                    n = snprintf( buf + pos, len - pos, spec,
+                            ( unsigned long )i );
+                else
+                    n = snprintf( buf + pos, len - pos, spec,
+                            ( unsigned int )i );
+                break;
+            case 'c':
+                n = snprintf( buf + pos, len - pos, spec, ( int )i );
+                break;
+            case 's':
+                n = snprintf( buf + pos, len - pos, spec,
+                        ( arg->type == SMX_LOG_ARG_STR ) ? arg->s : "?" );
+                break;
+            case 'p':
+                n = snprintf( buf + pos, len - pos, spec, arg->p );
+                break;
+            default:
+                if( mod == 'L' )
+                    n = snprintf( buf + pos, len - pos, spec,
+                            ( long double )arg->d );
+                else
+                    n = snprintf( buf + pos, len - pos, spec, arg->d );
+                break;
+        }
+        if( n < 0 )
+            break;
+        pos += n;
+        if( pos >= len )
+            pos = len - 1;
+    }
+    buf[pos] = '\0';
+    return pos;
+}
+
+/*****************************************************************************/
+void* smx_log_ring_run( void* arg )
+{
+    struct timespec ts;
+    ( void )arg;
+
+    ts.tv_sec = SMX_LOG_RING_FLUSH_INTERVAL_MS / 1000;
+    ts.tv_nsec = ( SMX_LOG_RING_FLUSH_INTERVAL_MS % 1000 ) * 1000000;
+    while( __atomic_load_n( &smx_log_is_running, __ATOMIC_ACQUIRE ) )
+    {
+        nanosleep( &ts, NULL );
+        smx_log_ring_flush();
+    }
+    return NULL;
+}
+
+/*****************************************************************************/
+int smx_log_ring_start()
+{
+    __atomic_store_n( &smx_log_is_running, true, __ATOMIC_RELEASE );
+    if( pthread_create( &smx_log_th, NULL, smx_log_ring_run, NULL ) != 0 )
+    {
+        smx_log_is_running = false;
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_log_ring_stop()
+{
+    smx_log_ring_t* ring;
+
+    if( !smx_log_is_running )
+        return;
+
+    __atomic_store_n( &smx_log_is_running, false, __ATOMIC_RELEASE );
+    pthread_join( smx_log_th, NULL );
+    smx_log_ring_flush();
+
+    pthread_mutex_lock( &mlog_ring );
+    while( smx_log_rings != NULL )
+    {
+        ring = smx_log_rings;
+        smx_log_rings = ring->next;
+        smx_log_ring_destroy( ring );
+    }
+    pthread_mutex_unlock( &mlog_ring );
+}
+
+/*****************************************************************************/
+int smx_log_ring_thread_init()
+{
+    if( !__atomic_load_n( &smx_log_is_running, __ATOMIC_ACQUIRE )
+            || smx_log_thread_ring != NULL )
+        return 0;
+
+    smx_log_thread_ring = smx_log_ring_create( SMX_LOG_RING_SIZE );
+    if( smx_log_thread_ring == NULL )
+        return -1;
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_log_ring_write( zlog_category_t* cat, int level, const char* file,
+        const char* func, int line, const char* format, smx_log_arg_t* args,
+        int arg_count )
+{
+    int i;
+    size_t len;
+    size_t str_pos = 0;
+    uint64_t head = 0;
+    smx_log_ring_t* ring = NULL;
+    smx_log_record_t* record;
+    smx_log_record_t local;
+
+    if( cat == NULL )
+        return;
+
+    // without the log thread the record is emitted by the caller
+    record = &local;
+    if( __atomic_load_n( &smx_log_is_running, __ATOMIC_ACQUIRE ) )
+    {
+        if( smx_log_thread_ring == NULL )
+            smx_log_thread_ring = smx_log_ring_create( SMX_LOG_RING_SIZE );
+        ring = smx_log_thread_ring;
+    }
+    if( ring != NULL )
+    {
+        head = ring->head;
+        if( head - __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE )
+                > ring->mask )
+        {
+            __atomic_store_n( &ring->drop_count, ring->drop_count + 1,
+                    __ATOMIC_RELAXED );
+            return;
+        }
+        record = &ring->records[head & ring->mask];
+    }
+
+    record->cat = cat;
+    record->file = file;
+    record->func = func;
+    record->format = format;
+    record->line = line;
+    record->level = level;
+    record->arg_count = SMX_MIN( arg_count, SMX_LOG_RING_MAX_ARGS );
+    for( i = 0; i < record->arg_count; i++ )
+    {
+        record->args[i] = args[i];
+        if( args[i].type != SMX_LOG_ARG_STR )
+            continue;
+        // copy the string, truncate it if the buffer is full
+        len = strlen( args[i].s );
+        len = SMX_MIN( len, SMX_LOG_RING_STR_SIZE - str_pos - 1 );
+        memcpy( record->strs + str_pos, args[i].s, len );
+        record->strs[str_pos + len] = '\0';
+        record->args[i].s = record->strs + str_pos;
+        str_pos += len;
+        if( str_pos + 1 < SMX_LOG_RING_STR_SIZE )
+            str_pos++;
+    }
+
+    if( ring == NULL )
+        smx_log_ring_emit( record );
+    else
+        __atomic_store_n( &ring->head, head + 1, __ATOMIC_RELEASE );
+}
@@ -0,0 +1,665 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Live metrics for the runtime system library of Streamix
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "smxhist.h"
+#include "smxmetrics.h"
+#include "smxlog.h"
+#include "smxutils.h"
+
+/*****************************************************************************/
+smx_metrics_t* smx_metrics_create( bson_t* conf )
+{
+    bson_iter_t iter;
+    bson_iter_t child;
+    char shm_name[100];
+    smx_metrics_t* metrics;
+
+    if( !( bson_iter_init_find( &iter, conf, "_metrics" )
+            && BSON_ITER_HOLDS_DOCUMENT( &iter ) ) )
+        return NULL;
+
+    metrics = smx_malloc( sizeof( struct smx_metrics_s ) );
+    if( metrics == NULL )
+        return NULL;
+
+    metrics->shm_name = NULL;
+    metrics->fd = -1;
+    metrics->size = 0;
+    metrics->map = NULL;
+    metrics->header = NULL;
+    metrics->nets = NULL;
+    metrics->chs = NULL;
+    metrics->has_shm = true;
+    metrics->socket_path = NULL;
+    metrics->port = 0;
+    metrics->server_fd = -1;
+    metrics->is_serving = false;
+    metrics->rts = NULL;
+
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "shm" )
+            && BSON_ITER_HOLDS_BOOL( &child ) )
+    {
+        metrics->has_shm = bson_iter_bool( &child );
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "socket" )
+            && BSON_ITER_HOLDS_UTF8( &child ) )
+    {
+        metrics->socket_path = bson_iter_dup_utf8( &child, NULL );
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "port" )
+            && BSON_ITER_HOLDS_INT32( &child ) )
+    {
+        metrics->port = bson_iter_int32( &child );
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "shm_name" )
+            && BSON_ITER_HOLDS_UTF8( &child ) )
+    {
+        metrics->shm_name = bson_iter_dup_utf8( &child, NULL );
+    }
+    else
+    {
+        sprintf( shm_name, "/smx-%d", getpid() );
+        metrics->shm_name = strdup( shm_name );
+    }
+
+    return metrics;
+}
+
+/*****************************************************************************/
+void smx_metrics_destroy( smx_metrics_t* metrics )
+{
+    if( metrics == NULL )
+        return;
+
+    smx_metrics_stop( metrics );
+    if( metrics->map != NULL )
+        munmap( metrics->map, metrics->size );
+    if( metrics->fd >= 0 )
+    {
+        close( metrics->fd );
+        shm_unlink( metrics->shm_name );
+    }
+    if( metrics->shm_name != NULL )
+        free( metrics->shm_name );
+    if( metrics->socket_path != NULL )
+        free( metrics->socket_path );
+    free( metrics );
+}
+
+/*****************************************************************************/
+size_t smx_metrics_get_size( int net_count, int ch_count )
+{
+    return sizeof( struct smx_metrics_header_s )
+        + net_count * sizeof( struct smx_metrics_net_s )
+        + ch_count * sizeof( struct smx_metrics_ch_s );
+}
+
+/*****************************************************************************/
+void smx_metrics_server_handle( smx_metrics_t* metrics, int fd )
+{
+    char request[SMX_METRICS_REQUEST_LEN];
+    char header[200];
+    size_t len = 0;
+    size_t body_len = 0;
+    ssize_t rc;
+    char* body = NULL;
+    FILE* f;
+    struct timeval tv;
+
+    tv.tv_sec = 0;
+    tv.tv_usec = SMX_METRICS_POLL_INTERVAL_MS * 1000;
+    setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+    setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof( tv ) );
+
+    // any request is answered with the metrics, only the end is awaited
+    request[0] = '\0';
+    while( len < sizeof( request ) - 1 )
+    {
+        rc = read( fd, request + len, sizeof( request ) - 1 - len );
+        if( rc <= 0 )
+            break;
+        len += rc;
+        request[len] = '\0';
+        if( strstr( request, "\r\n\r\n" ) != NULL
+                || strstr( request, "\n\n" ) != NULL )
+            break;
+    }
+
+    f = open_memstream( &body, &body_len );
+    if( f == NULL )
+        return;
+    smx_metrics_write_prometheus( metrics, f );
+    fclose( f );
+
+    // a connection without request (e.g. netcat) gets the plain exposition
+    if( len > 0 )
+    {
+        rc = snprintf( header, sizeof( header ), "HTTP/1.0 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: %zu\r\nConnection: close\r\n\r\n", body_len );
+        send( fd, header, rc, MSG_NOSIGNAL );
+    }
+    len = 0;
+    while( len < body_len )
+    {
+        rc = send( fd, body + len, body_len - len, MSG_NOSIGNAL );
+        if( rc <= 0 )
+            break;
+        len += rc;
+    }
+    free( body );
+}
+
+/*****************************************************************************/
+int smx_metrics_server_open( smx_metrics_t* metrics )
+{
+    int opt = 1;
+    struct sockaddr_un addr_un;
+    struct sockaddr_in addr_in;
+
+    if( metrics->socket_path != NULL )
+    {
+        if( strlen( metrics->socket_path ) >= sizeof( addr_un.sun_path ) )
+        {
+            SMX_LOG_MAIN( main, error, "metrics socket path '%s' is too long",
+                    metrics->socket_path );
+            return -1;
+        }
+        metrics->server_fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        if( metrics->server_fd < 0 )
+            goto error;
+        memset( &addr_un, 0, sizeof( addr_un ) );
+        addr_un.sun_family = AF_UNIX;
+        strcpy( addr_un.sun_path, metrics->socket_path );
+        // remove a stale socket of a previous run
+        unlink( metrics->socket_path );
+        if( bind( metrics->server_fd, ( struct sockaddr* )&addr_un,
+                    sizeof( addr_un ) ) < 0 )
+            goto error;
+    }
+    else
+    {
+        metrics->server_fd = socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        if( metrics->server_fd < 0 )
+            goto error;
+        setsockopt( metrics->server_fd, SOL_SOCKET, SO_REUSEADDR, &opt,
+                sizeof( opt ) );
+        memset( &addr_in, 0, sizeof( addr_in ) );
+        addr_in.sin_family = AF_INET;
+        addr_in.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        addr_in.sin_port = htons( metrics->port );
+        if( bind( metrics->server_fd, ( struct sockaddr* )&addr_in,
+                    sizeof( addr_in ) ) < 0 )
+            goto error;
+    }
+    if( listen( metrics->server_fd, 4 ) < 0 )
+        goto error;
+
+    if( metrics->socket_path != NULL )
+    {
+        SMX_LOG_MAIN( main, notice, "serving metrics on socket '%s'",
+                metrics->socket_path );
+    }
+    else
+    {
+        SMX_LOG_MAIN( main, notice, "serving metrics on 127.0.0.1:%d",
+                metrics->port );
+    }
+    return 0;
+
+error:
+    SMX_LOG_MAIN( main, error, "failed to open metrics endpoint: %s",
+            strerror( errno ) );
+    if( metrics->server_fd >= 0 )
+        close( metrics->server_fd );
+    metrics->server_fd = -1;
+    return -1;
+}
+
+/*****************************************************************************/
+void* smx_metrics_server_run( void* metrics )
+{
+    int fd;
+    smx_metrics_t* m = metrics;
+    struct pollfd pfd;
+
+    pfd.fd = m->server_fd;
+    pfd.events = POLLIN;
+    while( __atomic_load_n( &m->is_serving, __ATOMIC_ACQUIRE ) )
+    {
+        if( poll( &pfd, 1, SMX_METRICS_POLL_INTERVAL_MS ) <= 0 )
+            continue;
+        fd = accept( m->server_fd, NULL, NULL );
+        if( fd < 0 )
+            continue;
+        smx_metrics_server_handle( m, fd );
+        close( fd );
+    }
+    return NULL;
+}
+
+/*****************************************************************************/
+void smx_metrics_set_net_state( smx_net_t* h, smx_metrics_net_state_t state )
+{
+    if( h == NULL || h->metrics == NULL )
+        return;
+
+    __atomic_store_n( &h->metrics->state, state, __ATOMIC_RELAXED );
+}
+
+/*****************************************************************************/
+int smx_metrics_start( smx_metrics_t* metrics, smx_rts_t* rts )
+{
+    int i;
+    smx_net_t* net;
+    smx_channel_t* ch;
+    smx_metrics_net_t* net_rec;
+    smx_metrics_ch_t* ch_rec;
+
+    if( metrics == NULL )
+        return 0;
+
+    metrics->rts = rts;
+    metrics->size = smx_metrics_get_size( rts->net_cnt, rts->ch_cnt );
+    if( metrics->has_shm )
+    {
+        metrics->fd = shm_open( metrics->shm_name,
+                O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if( metrics->fd < 0 )
+        {
+            SMX_LOG_MAIN( main, error, "failed to open metrics segment '%s':"
+                    " %s", metrics->shm_name, strerror( errno ) );
+            return -1;
+        }
+        if( ftruncate( metrics->fd, metrics->size ) < 0 )
+        {
+            SMX_LOG_MAIN( main, error, "failed to resize metrics segment: %s",
+                    strerror( errno ) );
+            return -1;
+        }
+        metrics->map = mmap( NULL, metrics->size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, metrics->fd, 0 );
+    }
+    else
+        metrics->map = mmap( NULL, metrics->size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( metrics->map == MAP_FAILED )
+    {
+        metrics->map = NULL;
+        SMX_LOG_MAIN( main, error, "failed to map metrics segment: %s",
+                strerror( errno ) );
+        return -1;
+    }
+
+    // the segment is zero-filled by ftruncate or mmap
+    metrics->header = ( smx_metrics_header_t* )metrics->map;
+    metrics->nets = ( smx_metrics_net_t* )( metrics->map
+            + sizeof( struct smx_metrics_header_s ) );
+    metrics->chs = ( smx_metrics_ch_t* )( metrics->nets + rts->net_cnt );
+
+    for( i = 0; i < rts->net_cnt; i++ )
+    {
+        net = rts->nets[i];
+        net_rec = &metrics->nets[i];
+        net_rec->id = -1;
+        if( net == NULL )
+            continue;
+        if( net->name != NULL )
+            strncpy( net_rec->name, net->name, SMX_METRICS_NAME_LEN - 1 );
+        net_rec->id = net->id;
+        net_rec->state = SMX_METRICS_NET_INIT;
+        net_rec->expected_rate = net->expected_rate;
+        net->metrics = net_rec;
+    }
+    for( i = 0; i < rts->ch_cnt; i++ )
+    {
+        ch = rts->chs[i];
+        ch_rec = &metrics->chs[i];
+        ch_rec->id = -1;
+        if( ch == NULL )
+            continue;
+        if( ch->name != NULL )
+            strncpy( ch_rec->name, ch->name, SMX_METRICS_NAME_LEN - 1 );
+        ch_rec->id = ch->id;
+        ch_rec->writer_net_id = ( ch->sink == NULL || ch->sink->net == NULL )
+            ? -1 : ( int )ch->sink->net->id;
+        ch_rec->reader_net_id = ( ch->source == NULL
+                || ch->source->net == NULL ) ? -1 : ( int )ch->source->net->id;
+        ch_rec->length = ( ch->fifo == NULL ) ? 0 : ch->fifo->length;
+        ch->metrics = ch_rec;
+    }
+
+    metrics->header->version = SMX_METRICS_VERSION;
+    metrics->header->header_size = sizeof( struct smx_metrics_header_s );
+    metrics->header->net_size = sizeof( struct smx_metrics_net_s );
+    metrics->header->ch_size = sizeof( struct smx_metrics_ch_s );
+    metrics->header->net_count = rts->net_cnt;
+    metrics->header->ch_count = rts->ch_cnt;
+    metrics->header->pid = getpid();
+    metrics->header->start_ts = smx_get_time_ns();
+    // the magic is written last such that a reader never sees a partial header
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    memcpy( metrics->header->magic, SMX_METRICS_MAGIC,
+            sizeof( metrics->header->magic ) );
+
+    if( metrics->has_shm )
+    {
+        SMX_LOG_MAIN( main, notice, "publishing metrics of %d nets and %d"
+                " channels in shared memory segment '%s'", rts->net_cnt,
+                rts->ch_cnt, metrics->shm_name );
+    }
+
+    if( metrics->socket_path == NULL && metrics->port <= 0 )
+        return 0;
+
+    if( smx_metrics_server_open( metrics ) < 0 )
+        return -1;
+    metrics->is_serving = true;
+    if( pthread_create( &metrics->th, NULL, smx_metrics_server_run,
+                metrics ) != 0 )
+    {
+        metrics->is_serving = false;
+        SMX_LOG_MAIN( main, error, "failed to create metrics thread" );
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_metrics_stop( smx_metrics_t* metrics )
+{
+    if( metrics == NULL )
+        return;
+
+    if( metrics->is_serving )
+    {
+        __atomic_store_n( &metrics->is_serving, false, __ATOMIC_RELEASE );
+        pthread_join( metrics->th, NULL );
+    }
+    if( metrics->server_fd >= 0 )
+    {
+        close( metrics->server_fd );
+        metrics->server_fd = -1;
+        if( metrics->socket_path != NULL )
+            unlink( metrics->socket_path );
+    }
+}
+
+/*****************************************************************************/
+void smx_metrics_update_ch( smx_channel_t* ch, bool is_read )
+{
+    smx_metrics_ch_t* rec = ch->metrics;
+
+    if( rec == NULL )
+        return;
+
+    __atomic_store_n( &rec->count, ch->fifo->count, __ATOMIC_RELAXED );
+    __atomic_store_n( &rec->overwrite, ch->fifo->overwrite, __ATOMIC_RELAXED );
+    __atomic_store_n( &rec->copy, ch->fifo->copy, __ATOMIC_RELAXED );
+    if( is_read )
+    {
+        __atomic_store_n( &rec->read_count, rec->read_count + 1,
+                __ATOMIC_RELAXED );
+        __atomic_store_n( &rec->read_err, ch->source->err, __ATOMIC_RELAXED );
+        __atomic_store_n( &rec->read_block_time, ch->source->block_time,
+                __ATOMIC_RELAXED );
+    }
+    else
+    {
+        __atomic_store_n( &rec->write_count, rec->write_count + 1,
+                __ATOMIC_RELAXED );
+        __atomic_store_n( &rec->write_err, ch->sink->err, __ATOMIC_RELAXED );
+        __atomic_store_n( &rec->write_block_time, ch->sink->block_time,
+                __ATOMIC_RELAXED );
+    }
+}
+
+/*****************************************************************************/
+void smx_metrics_update_net( smx_net_t* h, uint64_t impl_time )
+{
+    smx_metrics_net_t* rec = h->metrics;
+
+    if( rec == NULL )
+        return;
+
+    __atomic_store_n( &rec->count, h->count, __ATOMIC_RELAXED );
+    __atomic_store_n( &rec->impl_time, impl_time, __ATOMIC_RELAXED );
+    __atomic_store_n( &rec->impl_time_sum, rec->impl_time_sum + impl_time,
+            __ATOMIC_RELAXED );
+}
+
+/*****************************************************************************/
+void smx_metrics_write_family( FILE* f, const char* name, const char* type,
+        const char* help )
+{
+    fprintf( f, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type );
+}
+
+/*****************************************************************************/
+void smx_metrics_write_labels( FILE* f, const char* name, int id )
+{
+    fputs( "name=\"", f );
+    while( *name != '\0' )
+    {
+        if( *name == '"' || *name == '\\' )
+            fputc( '\\', f );
+        if( *name == '\n' )
+            fputs( "\\n", f );
+        else
+            fputc( *name, f );
+        name++;
+    }
+    fprintf( f, "\",id=\"%d\"", id );
+}
+
+/*****************************************************************************/
+void smx_metrics_write_prometheus( smx_metrics_t* metrics, FILE* f )
+{
+    uint32_t i;
+    smx_metrics_header_t* header = metrics->header;
+    smx_metrics_net_t* nets = metrics->nets;
+    smx_metrics_ch_t* chs = metrics->chs;
+    smx_rts_t* rts = metrics->rts;
+
+    smx_metrics_write_family( f, "smx_net_state", "gauge", "The state of the"
+            " net (0: init, 1: run, 2: blocked read, 3: blocked write,"
+            " 4: end)." );
+    for( i = 0; i < header->net_count; i++ )
+    {
+        if( nets[i].id < 0 ) continue;
+        fputs( "smx_net_state{", f );
+        smx_metrics_write_labels( f, nets[i].name, nets[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &nets[i].state,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_net_loops_total", "counter",
+            "The number of net loop iterations." );
+    for( i = 0; i < header->net_count; i++ )
+    {
+        if( nets[i].id < 0 ) continue;
+        fputs( "smx_net_loops_total{", f );
+        smx_metrics_write_labels( f, nets[i].name, nets[i].id );
+        fprintf( f, "} %lu\n", __atomic_load_n( &nets[i].count,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_net_impl_duration_seconds", "summary",
+            "The execution time of the box implementation." );
+    for( i = 0; i < header->net_count; i++ )
+    {
+        if( nets[i].id < 0 ) continue;
+        smx_metrics_write_summary( f, "smx_net_impl_duration_seconds",
+                nets[i].name, nets[i].id, rts->nets[i]->impl_hist );
+    }
+    smx_metrics_write_family( f, "smx_net_loop_period_seconds", "summary",
+            "The time between the start of two net loop iterations." );
+    for( i = 0; i < header->net_count; i++ )
+    {
+        if( nets[i].id < 0 ) continue;
+        smx_metrics_write_summary( f, "smx_net_loop_period_seconds",
+                nets[i].name, nets[i].id, rts->nets[i]->loop_hist );
+    }
+
+    smx_metrics_write_family( f, "smx_channel_messages", "gauge",
+            "The number of messages queued in the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_messages{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &chs[i].count,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_capacity", "gauge",
+            "The length of the channel FIFO." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_capacity{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", chs[i].length );
+    }
+    smx_metrics_write_family( f, "smx_channel_reads_total", "counter",
+            "The number of read operations on the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_reads_total{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %lu\n", __atomic_load_n( &chs[i].read_count,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_writes_total", "counter",
+            "The number of write operations on the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_writes_total{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %lu\n", __atomic_load_n( &chs[i].write_count,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_overwrites", "gauge",
+            "The number of consecutive overwrites of the FIFO tail." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_overwrites{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &chs[i].overwrite,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_duplicates", "gauge",
+            "The number of consecutive duplications of the backup message." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_duplicates{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &chs[i].copy,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_read_blocked_seconds_total",
+            "counter", "The time the consumer was blocked on the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_read_blocked_seconds_total{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %.9f\n", __atomic_load_n( &chs[i].read_block_time,
+                    __ATOMIC_RELAXED ) / 1e9 );
+    }
+    smx_metrics_write_family( f, "smx_channel_write_blocked_seconds_total",
+            "counter", "The time the producer was blocked on the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_write_blocked_seconds_total{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %.9f\n", __atomic_load_n( &chs[i].write_block_time,
+                    __ATOMIC_RELAXED ) / 1e9 );
+    }
+    smx_metrics_write_family( f, "smx_channel_read_error", "gauge",
+            "The error code of the last read operation (0: no error)." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_read_error{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &chs[i].read_err,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_write_error", "gauge",
+            "The error code of the last write operation (0: no error)." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        fputs( "smx_channel_write_error{", f );
+        smx_metrics_write_labels( f, chs[i].name, chs[i].id );
+        fprintf( f, "} %d\n", __atomic_load_n( &chs[i].write_err,
+                    __ATOMIC_RELAXED ) );
+    }
+    smx_metrics_write_family( f, "smx_channel_latency_seconds", "summary",
+            "The end-to-end latency of the messages read from the channel." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        smx_metrics_write_summary( f, "smx_channel_latency_seconds",
+                chs[i].name, chs[i].id, rts->chs[i]->latency_hist );
+    }
+    smx_metrics_write_family( f, "smx_channel_queue_delay_seconds", "summary",
+            "The time the messages spent in the channel FIFO." );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 ) continue;
+        smx_metrics_write_summary( f, "smx_channel_queue_delay_seconds",
+                chs[i].name, chs[i].id, rts->chs[i]->queue_hist );
+    }
+}
+
+/*****************************************************************************/
+void smx_metrics_write_summary( FILE* f, const char* family, const char* name,
+        int id, smx_hist_t* hist )
+{
+    int i;
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    if( hist == NULL )
+        return;
+
+    for( i = 0; i < 4; i++ )
+    {
+        fprintf( f, "%s{", family );
+        smx_metrics_write_labels( f, name, id );
+        fprintf( f, ",quantile=\"%g\"} %.9f\n", quantiles[i],
+                smx_hist_get_percentile( hist, quantiles[i] * 100 ) / 1e9 );
+    }
+    fprintf( f, "%s_sum{", family );
+    smx_metrics_write_labels( f, name, id );
+    fprintf( f, "} %.9f\n", __atomic_load_n( &hist->sum, __ATOMIC_RELAXED )
+            / 1e9 );
+    fprintf( f, "%s_count{", family );
+    smx_metrics_write_labels( f, name, id );
+    fprintf( f, "} %lu\n", __atomic_load_n( &hist->count, __ATOMIC_RELAXED ) );
+}
@@ -23,14 +23,17 @@ smx_msg_t* smx_msg_copy( void* h, smx_msg_t* msg )
 
     SMX_LOG_MAIN( msg, info, "copy message '%llu' in net '%s(%d)'", msg->id,
             SMX_NET_GET_NAME( h ), SMX_NET_GET_ID( h ) );
-    smx_profiler_log_msg( h, msg, SMX_PROFILER_ACTION_MSG_COPY_START );
-    smx_msg_t* copy = smx_msg_create( h, msg->copy( msg->data, msg->size ),
-            msg->size, msg->copy, msg->destroy, msg->unpack );
+    SMX_PROFILER_LOG_MSG( h, msg, SMX_PROFILER_ACTION_MSG_COPY_START );
+    smx_msg_t* copy = smx_msg_create_from( h, msg,
+            msg->copy( msg->data, msg->size ), msg->size, msg->copy,
+            msg->destroy, msg->unpack );
     if( msg->type != NULL )
         smx_msg_set_type( copy, msg->type );
     if( msg->prevent_backup )
         smx_msg_prevent_backup( copy );
-    smx_profiler_log_msg( h, msg, SMX_PROFILER_ACTION_MSG_COPY_END );
+    if( msg->has_partition_key )
+        smx_msg_set_partition_key( copy, msg->partition_key );
+    SMX_PROFILER_LOG_MSG( h, msg, SMX_PROFILER_ACTION_MSG_COPY_END );
     return copy;
 }
 
@@ -38,20 +41,45 @@ smx_msg_t* smx_msg_copy( void* h, smx_msg_t* msg )
 smx_msg_t* smx_msg_create( void* h, void* data, size_t size,
         void* copy( void*, size_t ), void destroy( void* ),
         void* unpack( void* ) )
+{
+    return smx_msg_create_from( h, NULL, data, size, copy, destroy, unpack );
+}
+
+/*****************************************************************************/
+smx_msg_t* smx_msg_create_from( void* h, smx_msg_t* parent, void* data,
+        size_t size, void* copy( void*, size_t ), void destroy( void* ),
+        void* unpack( void* ) )
 {
     static unsigned long msg_count = 0;
+    smx_net_t* net = h;
     smx_msg_t* msg = smx_malloc( sizeof( struct smx_msg_s ) );
     if( msg == NULL )
         return NULL;
 
     msg->id = msg_count++;
+    msg->create_ts = smx_get_time_ns();
+    if( parent != NULL )
+    {
+        msg->origin_ts = parent->origin_ts;
+        msg->is_traced = parent->is_traced;
+    }
+    else
+    {
+        msg->origin_ts = msg->create_ts;
+        // only the creating net writes its sample counter
+        msg->is_traced = ( net == NULL || net->profiler_sample_rate <= 1
+                || net->profiler_sample_count++ % net->profiler_sample_rate
+                    == 0 );
+    }
     SMX_LOG_MAIN( msg, info, "create message '%llu' in '%s(%d)'", msg->id,
             SMX_NET_GET_NAME( h ), SMX_NET_GET_ID( h ) );
-    smx_profiler_log_msg( h, msg, SMX_PROFILER_ACTION_MSG_CREATE );
+    SMX_PROFILER_LOG_MSG( h, msg, SMX_PROFILER_ACTION_MSG_CREATE );
     msg->type = NULL;
     msg->data = data;
     msg->size = size;
     msg->prevent_backup = false;
+    msg->partition_key = 0;
+    msg->has_partition_key = false;
     if( copy == NULL ) msg->copy = smx_msg_data_copy;
     else msg->copy = copy;
     if( destroy == NULL ) msg->destroy = smx_msg_data_destroy;
@@ -95,7 +123,7 @@ void smx_msg_destroy( void* h, smx_msg_t* msg, int deep )
 
     SMX_LOG_MAIN( msg, info, "destroy message '%llu' in '%s(%d)'", msg->id,
             SMX_NET_GET_NAME( h ), SMX_NET_GET_ID( h ) );
-    smx_profiler_log_msg( h, msg, SMX_PROFILER_ACTION_MSG_DESTROY );
+    SMX_PROFILER_LOG_MSG( h, msg, SMX_PROFILER_ACTION_MSG_DESTROY );
     if( deep )
         msg->destroy( msg->data );
     if( msg->type != NULL )
@@ -127,6 +155,23 @@ int smx_msg_filter( smx_msg_t* msg, int count, ... )
     return (i < count) ? i : -1;
 }
 
+/*****************************************************************************/
+uint64_t smx_msg_get_latency( smx_msg_t* msg )
+{
+    uint64_t now = smx_get_time_ns();
+    return ( now > msg->origin_ts ) ? now - msg->origin_ts : 0;
+}
+
+/*****************************************************************************/
+void smx_msg_inherit_origin( smx_msg_t* msg, smx_msg_t* parent )
+{
+    if( msg == NULL || parent == NULL )
+        return;
+
+    msg->origin_ts = parent->origin_ts;
+    msg->is_traced = parent->is_traced;
+}
+
 /*****************************************************************************/
 void smx_msg_prevent_backup( smx_msg_t* msg )
 {
@@ -139,6 +184,19 @@ void* smx_msg_unpack( smx_msg_t* msg )
     return msg->unpack( msg->data );
 }
 
+/*****************************************************************************/
+void smx_msg_set_partition_key( smx_msg_t* msg, uint64_t key )
+{
+    msg->partition_key = key;
+    msg->has_partition_key = true;
+}
+
+/*****************************************************************************/
+void smx_msg_set_partition_key_str( smx_msg_t* msg, const char* key )
+{
+    smx_msg_set_partition_key( msg, smx_hash_str( key ) );
+}
+
 /*****************************************************************************/
 int smx_msg_set_type( smx_msg_t* msg, const char* type )
 {
@@ -14,13 +14,134 @@
 #include <stdbool.h>
 #include <string.h>
 #include <pthread.h>
+#include "box_smx_dispatch.h"
+#include "box_smx_merge.h"
+#include "box_smx_rn.h"
 #include "smxch.h"
 #include "smxconfig.h"
+#include "smxhist.h"
+#include "smxmetrics.h"
 #include "smxnet.h"
 #include "smxmsg.h"
 #include "smxprofiler.h"
 #include "smxutils.h"
 
+/*****************************************************************************/
+smx_net_t* smx_net_alloc( unsigned int id, const char* name,
+        const char* impl, const char* cat_name, smx_rts_t* rts, int prio )
+{
+    if( id >= SMX_MAX_NETS )
+    {
+        SMX_LOG_MAIN( main, fatal, "net count exeeds maximum %d", id );
+        return NULL;
+    }
+
+    smx_net_t* net = smx_malloc( sizeof( struct smx_net_s ) );
+    if( net == NULL )
+        return NULL;
+
+    net->sig = smx_malloc( sizeof( struct smx_net_sig_s ) );
+    if( net->sig == NULL )
+    {
+        free( net );
+        return NULL;
+    }
+    net->last_count_wall.tv_sec = 0;
+    net->last_count_wall.tv_nsec = 0;
+    net->start_wall.tv_sec = 0;
+    net->start_wall.tv_nsec = 0;
+    net->end_wall.tv_sec = 0;
+    net->end_wall.tv_nsec = 0;
+    net->count = 0;
+    net->sig->in.ports = NULL;
+    net->sig->in.count = 0;
+    net->sig->in.len = 0;
+    net->sig->out.ports = NULL;
+    net->sig->out.count = 0;
+    net->sig->out.len = 0;
+
+    net->rts = rts;
+    net->state = NULL;
+    net->shared_state = NULL;
+    net->id = id;
+    net->priority = prio;
+    net->cat = zlog_get_category( cat_name );
+    net->log_level = smx_log_get_level( net->cat );
+    net->name = ( name == NULL ) ? NULL : strdup( name );
+    net->impl = ( impl == NULL ) ? NULL : strdup( impl );
+    net->attr = NULL;
+    net->conf = NULL;
+    net->conf_version = 0;
+    net->static_conf = NULL;
+    net->dyn_conf = NULL;
+    net->has_profiler = false;
+    net->has_type_filter = false;
+    net->is_disabled = false;
+    net->is_rn = false;
+    net->conf_port_name = NULL;
+    net->conf_port_timeout = 0;
+    net->expected_rate = 0;
+    net->shared_state_key = NULL;
+    net->replicas = 0;
+    net->group = NULL;
+    net->wake_threshold = 0;
+    net->wake_delay_us = 0;
+    net->has_latency_hist = false;
+    net->profiler_mask = 0;
+    net->profiler_sample_rate = 0;
+    net->profiler_sample_count = 0;
+    net->has_queue_hist = false;
+    net->tracer_ring = NULL;
+    net->impl_hist = smx_hist_create();
+    net->loop_hist = smx_hist_create();
+    net->metrics = NULL;
+
+    return net;
+}
+
+/*****************************************************************************/
+smx_net_t* smx_net_clone( smx_net_t* h, unsigned int id )
+{
+    char cat_name[1000];
+    smx_net_t* net;
+
+    if( h == NULL )
+        return NULL;
+
+    sprintf( cat_name, "net_%s_%d", h->name, id );
+    net = smx_net_alloc( id, h->name, h->impl, cat_name, h->rts, h->priority );
+    if( net == NULL )
+        return NULL;
+
+    if( h->static_conf != NULL )
+    {
+        net->static_conf = bson_copy( h->static_conf );
+        smx_net_set_conf( net, net->static_conf );
+    }
+    net->has_profiler = h->has_profiler;
+    net->has_type_filter = h->has_type_filter;
+    net->is_disabled = h->is_disabled;
+    net->conf_port_name = h->conf_port_name;
+    net->conf_port_timeout = h->conf_port_timeout;
+    net->expected_rate = h->expected_rate;
+    net->shared_state_key = h->shared_state_key;
+    net->wake_threshold = h->wake_threshold;
+    net->wake_delay_us = h->wake_delay_us;
+    net->has_latency_hist = h->has_latency_hist;
+    net->profiler_mask = h->profiler_mask;
+    net->profiler_sample_rate = h->profiler_sample_rate;
+    net->has_queue_hist = h->has_queue_hist;
+
+    smx_net_init( net, h->sig->in.len, h->sig->out.len );
+    net->sig->in.count = h->sig->in.count;
+    net->sig->out.count = h->sig->out.count;
+
+    h->rts->net_cnt++;
+    SMX_LOG_MAIN( net, info, "create net instance %s(%d) as replica of %s(%d)",
+            net->name, id, h->name, h->id );
+    return net;
+}
+
 /*****************************************************************************/
 smx_msg_t* smx_net_collector_read( void* h, smx_collector_t* collector,
         smx_channel_t** in, int count_in, int* last_idx )
@@ -33,7 +154,7 @@ smx_msg_t* smx_net_collector_read( void* h, smx_collector_t* collector,
     pthread_mutex_lock( &collector->col_mutex );
     while( collector->state == SMX_CHANNEL_PENDING && rc == 0 )
     {
-        smx_profiler_log_ch( h, in[0], NULL,
+        SMX_PROFILER_LOG_CH( h, in[0], NULL,
                 SMX_PROFILER_ACTION_CH_READ_COLLECTOR_BLOCK,
                 collector->count );
         SMX_LOG_NET( h, debug, "waiting for message on collector" );
@@ -77,77 +198,226 @@ smx_msg_t* smx_net_collector_read( void* h, smx_collector_t* collector,
 }
 
 /*****************************************************************************/
-smx_net_t* smx_net_create( unsigned int id, const char* name,
-        const char* impl, const char* cat_name, smx_rts_t* rts, int prio )
+int smx_net_conf_index_add( smx_hmap_t* index, const char* path,
+        bson_iter_t* iter )
 {
-    if( id >= SMX_MAX_NETS )
+    uint32_t len;
+    const uint8_t* data;
+    bson_t* doc;
+
+    // keep the first occurence of duplicate keys
+    if( !BSON_ITER_HOLDS_DOCUMENT( iter )
+            || smx_hmap_get( index, path ) != NULL )
+        return 0;
+
+    doc = smx_malloc( sizeof( bson_t ) );
+    if( doc == NULL )
+        return -1;
+    bson_iter_document( iter, &len, &data );
+    if( !bson_init_static( doc, data, len ) || smx_hmap_set( index, path,
+                doc ) < 0 )
     {
-        SMX_LOG_MAIN( main, fatal, "net count exeeds maximum %d", id );
+        free( doc );
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+bson_t* smx_net_conf_file_load( smx_hmap_t* cache, const char* path,
+        bson_error_t* error )
+{
+    int rc;
+    bson_t* doc;
+    bson_json_reader_t* reader;
+    struct timespec start;
+    struct timespec end;
+
+    if( cache != NULL )
+    {
+        doc = smx_hmap_get( cache, path );
+        if( doc != NULL )
+            return bson_copy( doc );
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    reader = bson_json_reader_new_from_file( path, error );
+    if( reader == NULL )
+        return NULL;
+
+    doc = bson_new();
+    rc = bson_json_reader_read( reader, doc, error );
+    bson_json_reader_destroy( reader );
+    if( rc < 0 )
+    {
+        bson_destroy( doc );
         return NULL;
     }
+    clock_gettime( CLOCK_MONOTONIC, &end );
+    SMX_LOG_MAIN( main, notice, "parsed net config file '%s' in %.3f ms", path,
+            smx_get_elapsed_ns( &start, &end ) / 1000000.0 );
 
-    smx_net_t* net = smx_malloc( sizeof( struct smx_net_s ) );
-    if( net == NULL )
+    if( cache == NULL || smx_hmap_set( cache, path, doc ) < 0 )
+        return doc;
+    return bson_copy( doc );
+}
+
+/*****************************************************************************/
+void smx_net_conf_files_destroy( smx_hmap_t* cache )
+{
+    size_t i;
+
+    if( cache == NULL )
+        return;
+
+    for( i = 0; i < cache->size; i++ )
+        if( cache->items[i].key != NULL )
+            bson_destroy( cache->items[i].val );
+    smx_hmap_destroy( cache, NULL );
+}
+
+/*****************************************************************************/
+smx_hmap_t* smx_net_conf_index_create( bson_t* conf )
+{
+    int rc = 0;
+    char path[1000];
+    bson_iter_t iter;
+    bson_iter_t i_impl;
+    bson_iter_t i_name;
+    bson_iter_t i_id;
+    const char* impl;
+    const char* name;
+    smx_hmap_t* index = smx_hmap_create( 64 );
+    if( index == NULL )
         return NULL;
 
-    net->sig = smx_malloc( sizeof( struct smx_net_sig_s ) );
-    if( net->sig == NULL )
+    if( !bson_iter_init_find( &iter, conf, "_nets" )
+            || !BSON_ITER_HOLDS_DOCUMENT( &iter )
+            || !bson_iter_recurse( &iter, &i_impl ) )
+        return index;
+
+    while( rc == 0 && bson_iter_next( &i_impl ) )
     {
-        free( net );
+        impl = bson_iter_key( &i_impl );
+        if( strcmp( impl, "_default" ) == 0 )
+        {
+            rc = smx_net_conf_index_add( index, impl, &i_impl );
+            continue;
+        }
+        if( !BSON_ITER_HOLDS_DOCUMENT( &i_impl )
+                || !bson_iter_recurse( &i_impl, &i_name ) )
+            continue;
+        while( rc == 0 && bson_iter_next( &i_name ) )
+        {
+            name = bson_iter_key( &i_name );
+            snprintf( path, sizeof( path ), "%s.%s", impl, name );
+            if( strcmp( name, "_default" ) == 0 )
+            {
+                rc = smx_net_conf_index_add( index, path, &i_name );
+                continue;
+            }
+            if( !BSON_ITER_HOLDS_DOCUMENT( &i_name )
+                    || !bson_iter_recurse( &i_name, &i_id ) )
+                continue;
+            while( rc == 0 && bson_iter_next( &i_id ) )
+            {
+                snprintf( path, sizeof( path ), "%s.%s.%s", impl, name,
+                        bson_iter_key( &i_id ) );
+                rc = smx_net_conf_index_add( index, path, &i_id );
+            }
+        }
+    }
+
+    if( rc < 0 )
+    {
+        smx_net_conf_index_destroy( index );
         return NULL;
     }
-    net->last_count_wall.tv_sec = 0;
-    net->last_count_wall.tv_nsec = 0;
-    net->start_wall.tv_sec = 0;
-    net->start_wall.tv_nsec = 0;
-    net->end_wall.tv_sec = 0;
-    net->end_wall.tv_nsec = 0;
-    net->count = 0;
-    net->sig->in.ports = NULL;
-    net->sig->in.count = 0;
-    net->sig->in.len = 0;
-    net->sig->out.ports = NULL;
-    net->sig->out.count = 0;
-    net->sig->out.len = 0;
+    SMX_LOG_MAIN( main, info, "indexed %zu net configuration levels",
+            index->count );
+    return index;
+}
 
-    net->rts = rts;
-    net->state = NULL;
-    net->shared_state = NULL;
-    net->id = id;
-    net->priority = prio;
-    net->cat = zlog_get_category( cat_name );
-    net->name = ( name == NULL ) ? NULL : strdup( name );
-    net->impl = ( impl == NULL ) ? NULL : strdup( impl );
-    net->attr = NULL;
-    net->conf = NULL;
-    net->static_conf = NULL;
-    net->dyn_conf = NULL;
-    smx_net_get_json_doc( net, rts->conf, name, impl, id );
-    net->has_profiler = smx_net_get_boolean_prop( rts->conf, name, impl, id,
-            "profiler" );
-    net->has_type_filter = smx_net_get_boolean_prop( rts->conf, name, impl, id,
-            "type_filter" );
-    net->is_disabled = smx_net_get_boolean_prop( rts->conf, name, impl, id,
-            "is_disabled" );
-    net->conf_port_name = smx_net_get_string_prop( rts->conf, name, impl, id,
-            "dyn_conf_port" );
-    net->conf_port_timeout = smx_net_get_int_prop( rts->conf, name, impl, id,
-            "dyn_conf_timeout" );
-    net->expected_rate = smx_net_get_int_prop( rts->conf, name, impl, id,
-            "expected_rate" );
-    net->shared_state_key = smx_net_get_string_prop( rts->conf, name, impl, id,
+/*****************************************************************************/
+void smx_net_conf_index_destroy( smx_hmap_t* index )
+{
+    smx_hmap_destroy( index, free );
+}
+
+/*****************************************************************************/
+smx_net_t* smx_net_create( unsigned int id, const char* name,
+        const char* impl, const char* cat_name, smx_rts_t* rts, int prio )
+{
+    smx_net_t* net = smx_net_alloc( id, name, impl, cat_name, rts, prio );
+    bson_t* levels[SMX_NET_CONF_LEVELS];
+    bson_iter_t iter;
+    if( net == NULL )
+        return NULL;
+
+    smx_net_get_conf_levels( rts->net_conf_index, name, impl, id, levels );
+    smx_net_get_json_doc( net, levels );
+    net->has_profiler = smx_net_get_boolean_prop( levels, "profiler" );
+    net->has_type_filter = smx_net_get_boolean_prop( levels, "type_filter" );
+    net->is_disabled = smx_net_get_boolean_prop( levels, "is_disabled" );
+    net->conf_port_name = smx_net_get_string_prop( levels, "dyn_conf_port" );
+    net->conf_port_timeout = smx_net_get_int_prop( levels, "dyn_conf_timeout" );
+    net->expected_rate = smx_net_get_int_prop( levels, "expected_rate" );
+    net->shared_state_key = smx_net_get_string_prop( levels,
             "shared_state_key" );
+    net->replicas = smx_net_get_int_prop( levels, "replicas" );
+    net->wake_threshold = smx_net_get_int_prop( levels, "wake_threshold" );
+    net->wake_delay_us = smx_net_get_int_prop( levels, "wake_delay_us" );
+    net->has_latency_hist = smx_net_get_boolean_prop( levels, "latency_hist" );
+    if( net->has_profiler )
+    {
+        // an omitted mask enables all classes, 0 disables all of them
+        net->profiler_mask = SMX_PROFILER_CLASS_ALL;
+        if( smx_net_get_prop( levels, "profiler_mask", BSON_TYPE_INT32,
+                    &iter ) )
+            net->profiler_mask = bson_iter_int32( &iter )
+                & SMX_PROFILER_CLASS_ALL;
+    }
+    net->profiler_sample_rate = smx_net_get_int_prop( levels,
+            "profiler_sample_rate" );
+    net->has_queue_hist = smx_net_get_boolean_prop( levels, "queue_hist" );
 
     rts->net_cnt++;
     SMX_LOG_MAIN( net, info, "create net instance %s(%d)", name, id );
     return net;
 }
 
+/*****************************************************************************/
+smx_net_t* smx_net_create_internal( smx_rts_t* rts, const char* impl,
+        int prio, int indegree, int outdegree )
+{
+    char cat_name[1000];
+    smx_net_t* net;
+    unsigned int id = rts->net_cnt;
+
+    sprintf( cat_name, "net_%s_%d", impl, id );
+    net = smx_net_create( id, impl, impl, cat_name, rts, prio );
+    if( net == NULL )
+        return NULL;
+
+    if( net->conf == NULL )
+    {
+        // internal nets do not require a configuration
+        net->static_conf = bson_new();
+        smx_net_set_conf( net, net->static_conf );
+    }
+    smx_net_init( net, indegree, outdegree );
+    rts->nets[id] = net;
+    return net;
+}
+
 /*****************************************************************************/
 void smx_net_destroy( smx_net_t* h )
 {
     if( h != NULL )
     {
+        smx_net_group_destroy( h );
+        smx_hist_destroy( h->impl_hist );
+        smx_hist_destroy( h->loop_hist );
         if( h->name != NULL )
             free( h->name );
         if( h->impl != NULL )
@@ -173,206 +443,448 @@ void smx_net_destroy( smx_net_t* h )
 }
 
 /*****************************************************************************/
-bool smx_net_get_boolean_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop )
+bool smx_net_get_boolean_prop( bson_t** levels, const char* prop )
 {
     bson_iter_t iter;
-    bson_iter_t child;
-    char search_str[1000];
-    const char* nets = "_nets";
-    sprintf( search_str, "%s.%s.%s.%d.%s", nets, impl, name, id, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_BOOL( &child ) )
-    {
-        return bson_iter_bool( &child );
-    }
-    sprintf( search_str, "%s.%s.%s._default.%s", nets, impl, name, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_BOOL( &child ) )
-    {
-        return bson_iter_bool( &child );
-    }
-    sprintf( search_str, "%s.%s._default.%s", nets, impl, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_BOOL( &child ) )
-    {
-        return bson_iter_bool( &child );
-    }
-    sprintf( search_str, "%s._default.%s", nets, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_BOOL( &child ) )
-    {
-        return bson_iter_bool( &child );
-    }
+    if( smx_net_get_prop( levels, prop, BSON_TYPE_BOOL, &iter ) )
+        return bson_iter_bool( &iter );
 
     return false;
 }
 
 /*****************************************************************************/
-int smx_net_get_int_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop )
+void smx_net_get_conf_levels( smx_hmap_t* index, const char* name,
+        const char* impl, unsigned int id, bson_t** levels )
 {
-    bson_iter_t iter;
-    bson_iter_t child;
-    char search_str[1000];
-    const char* nets = "_nets";
-    sprintf( search_str, "%s.%s.%s.%d.%s", nets, impl, name, id, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_INT32( &child ) )
-    {
-        return bson_iter_int32( &child );
-    }
-    sprintf( search_str, "%s.%s.%s._default.%s", nets, impl, name, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_INT32( &child ) )
-    {
-        return bson_iter_int32( &child );
-    }
-    sprintf( search_str, "%s.%s._default.%s", nets, impl, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_INT32( &child ) )
-    {
-        return bson_iter_int32( &child );
-    }
-    sprintf( search_str, "%s._default.%s", nets, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_INT32( &child ) )
+    char path[1000];
+
+    if( index == NULL )
     {
-        return bson_iter_int32( &child );
+        memset( levels, 0, sizeof( bson_t* ) * SMX_NET_CONF_LEVELS );
+        return;
     }
+    snprintf( path, sizeof( path ), "%s.%s.%d", impl, name, id );
+    levels[0] = smx_hmap_get( index, path );
+    snprintf( path, sizeof( path ), "%s.%s._default", impl, name );
+    levels[1] = smx_hmap_get( index, path );
+    snprintf( path, sizeof( path ), "%s._default", impl );
+    levels[2] = smx_hmap_get( index, path );
+    levels[3] = smx_hmap_get( index, "_default" );
+}
+
+/*****************************************************************************/
+uint64_t smx_net_get_impl_time( smx_net_t* h, double percentile )
+{
+    if( h == NULL || h->impl_hist == NULL )
+        return 0;
+
+    return smx_hist_get_percentile( h->impl_hist, percentile );
+}
+
+/*****************************************************************************/
+int smx_net_get_int_prop( bson_t** levels, const char* prop )
+{
+    bson_iter_t iter;
+    if( smx_net_get_prop( levels, prop, BSON_TYPE_INT32, &iter ) )
+        return bson_iter_int32( &iter );
 
     return false;
 }
 
 /*****************************************************************************/
-int smx_net_get_json_doc( smx_net_t* h, bson_t* conf, const char* name,
-        const char* impl, unsigned int id )
+int smx_net_get_json_doc( smx_net_t* h, bson_t** levels )
 {
-    const char* nets = "_nets";
-    const char* config = "config";
-    char search_str[1000];
-    int rc;
-    sprintf( search_str, "%s.%s.%s.%d.%s", nets, impl, name, id, config );
-    rc = smx_net_get_json_doc_item( h, conf, search_str );
-    if(rc < 0)
-    {
-        sprintf( search_str, "%s.%s.%s._default.%s", nets, impl, name, config );
-        rc = smx_net_get_json_doc_item( h, conf, search_str );
-    }
-    if(rc < 0)
-    {
-        sprintf( search_str, "%s.%s._default.%s", nets, impl, config );
-        rc = smx_net_get_json_doc_item( h, conf, search_str );
-    }
-    if(rc < 0)
+    int i;
+    bson_iter_t iter;
+    const char* level_names[SMX_NET_CONF_LEVELS] = { "net id", "net name",
+        "box implementation", "all nets" };
+
+    for( i = 0; i < SMX_NET_CONF_LEVELS; i++ )
     {
-        sprintf( search_str, "%s._default.%s", nets, config );
-        rc = smx_net_get_json_doc_item( h, conf, search_str );
+        if( levels[i] != NULL && bson_iter_init_find( &iter, levels[i],
+                    "config" )
+                && smx_net_get_json_doc_item( h, &iter, level_names[i] ) == 0 )
+            return 0;
     }
 
-    return rc;
+    return -1;
 }
 
 /*****************************************************************************/
-int smx_net_get_json_doc_item( smx_net_t* h, bson_t* conf,
-        const char* search_str )
+int smx_net_get_json_doc_item( smx_net_t* h, bson_iter_t* item,
+        const char* level )
 {
-    int rc;
     uint32_t len;
     const uint8_t* nets;
     const char* config;
-    bson_iter_t iter;
-    bson_iter_t child;
-    bson_json_reader_t *reader;
     bson_error_t error;
-    if( bson_iter_init( &iter, conf ) && bson_iter_find_descendant( &iter,
-                search_str, &child ) && BSON_ITER_HOLDS_DOCUMENT( &child ) )
+    if( BSON_ITER_HOLDS_DOCUMENT( item ) )
     {
-        bson_iter_document( &child, &len, &nets );
+        bson_iter_document( item, &len, &nets );
         h->static_conf = bson_new_from_data( nets, len );
-        h->conf = h->static_conf;
-        SMX_LOG_NET( h, notice, "load configuration '%s'", search_str );
+        smx_net_set_conf( h, h->static_conf );
+        SMX_LOG_NET( h, notice, "load configuration of the %s", level );
         return 0;
     }
-    else if( bson_iter_init( &iter, conf ) && bson_iter_find_descendant( &iter,
-                search_str, &child ) && BSON_ITER_HOLDS_UTF8( &child ) )
+    else if( BSON_ITER_HOLDS_UTF8( item ) )
     {
-        config = bson_iter_utf8( &child, NULL );
-        reader = bson_json_reader_new_from_file( config, &error );
-        if( reader == NULL )
+        config = bson_iter_utf8( item, NULL );
+        h->static_conf = smx_net_conf_file_load( h->rts->net_conf_files,
+                config, &error );
+        if( h->static_conf == NULL )
         {
             SMX_LOG_NET( h, error, "failed to load net config file '%s': %s",
                     config, error.message );
             return -1;
         }
+        smx_net_set_conf( h, h->static_conf );
+        SMX_LOG_NET( h, notice,
+                "load config file '%s' of the configuration of the %s",
+                config, level );
+        return 0;
+    }
+    SMX_LOG_NET( h, debug, "no configuration loaded from the %s", level );
+    return -1;
+}
+
+/*****************************************************************************/
+uint64_t smx_net_get_loop_time( smx_net_t* h, double percentile )
+{
+    if( h == NULL || h->loop_hist == NULL )
+        return 0;
 
-        h->static_conf = bson_new();
-        rc = bson_json_reader_read( reader, h->static_conf, &error );
-        h->conf = h->static_conf;
-        if( rc < 0 )
+    return smx_hist_get_percentile( h->loop_hist, percentile );
+}
+
+/*****************************************************************************/
+bool smx_net_get_prop( bson_t** levels, const char* prop, bson_type_t type,
+        bson_iter_t* iter )
+{
+    int i;
+    for( i = 0; i < SMX_NET_CONF_LEVELS; i++ )
+    {
+        if( levels[i] != NULL && bson_iter_init_find( iter, levels[i], prop )
+                && bson_iter_type( iter ) == type )
+            return true;
+    }
+
+    return false;
+}
+
+/*****************************************************************************/
+const char* smx_net_get_string_prop( bson_t** levels, const char* prop )
+{
+    bson_iter_t iter;
+    if( smx_net_get_prop( levels, prop, BSON_TYPE_UTF8, &iter ) )
+        return bson_iter_utf8( &iter, NULL );
+
+    return NULL;
+}
+
+/*****************************************************************************/
+int smx_net_group_create( smx_net_t* h )
+{
+    int i, r;
+    char cat_name[1000];
+    smx_rts_t* rts;
+    smx_net_group_t* group;
+    smx_net_t* net;
+    smx_channel_t* ch;
+    smx_channel_t* ch_replica;
+    bson_t* levels[SMX_NET_CONF_LEVELS];
+
+    if( h == NULL || h->replicas <= 1 || h->group != NULL )
+        return 0;
+
+    if( h->is_disabled )
+    {
+        SMX_LOG_NET( h, notice, "net is disabled, ignoring replicas" );
+        return 0;
+    }
+
+    if( h->attr != NULL || h->conf_port_name != NULL )
+    {
+        SMX_LOG_NET( h, error, "cannot replicate a special net or a net with"
+                " a dynamic configuration port" );
+        return -1;
+    }
+
+    for( i = 0; i < h->sig->in.len; i++ )
+    {
+        ch = h->sig->in.ports[i];
+        if( ch != NULL && ch->type != SMX_FIFO && ch->type != SMX_D_FIFO
+                && ch->type != SMX_RENDEZVOUS )
         {
-            SMX_LOG_NET( h, error,
-                    "failed to parse net config file '%s': %s",
-                    config, error.message );
+            SMX_LOG_NET( h, error, "cannot replicate net: input channel"
+                    " '%s(%d)' has a decoupled output", ch->name, ch->id );
+            return -1;
+        }
+    }
+    for( i = 0; i < h->sig->out.len; i++ )
+    {
+        ch = h->sig->out.ports[i];
+        if( ch != NULL && ch->type != SMX_FIFO && ch->type != SMX_FIFO_D
+                && ch->type != SMX_RENDEZVOUS )
+        {
+            SMX_LOG_NET( h, error, "cannot replicate net: output channel"
+                    " '%s(%d)' has a decoupled input", ch->name, ch->id );
             return -1;
         }
+    }
 
-        bson_json_reader_destroy( reader );
-        SMX_LOG_NET( h, notice,
-                "load config file '%s' of configuration item '%s'",
-                config, search_str );
-        return 0;
+    rts = h->rts;
+    group = smx_malloc( sizeof( struct smx_net_group_s ) );
+    if( group == NULL )
+        return -1;
+
+    group->count = 0;
+    group->dispatch_count = 0;
+    group->merge_count = 0;
+    group->ch_count = 0;
+    smx_net_get_conf_levels( rts->net_conf_index, h->name, h->impl, h->id,
+            levels );
+    group->is_partitioned = smx_net_get_boolean_prop( levels, "partitioned" );
+    group->replicas = smx_malloc( sizeof( smx_net_t* ) * h->replicas );
+    group->dispatchers = smx_malloc( sizeof( smx_net_t* ) * h->sig->in.len );
+    group->mergers = smx_malloc( sizeof( smx_net_t* ) * h->sig->out.len );
+    group->chs = smx_malloc( sizeof( smx_channel_t* ) * h->replicas
+            * ( h->sig->in.len + h->sig->out.len ) );
+    h->group = group;
+    if( group->replicas == NULL || group->dispatchers == NULL
+            || group->mergers == NULL || group->chs == NULL )
+        goto error;
+
+    group->replicas[group->count++] = h;
+    for( r = 1; r < h->replicas; r++ )
+    {
+        net = smx_net_clone( h, rts->net_cnt );
+        if( net == NULL )
+            goto error;
+        rts->nets[net->id] = net;
+        group->replicas[group->count++] = net;
+    }
+
+    for( i = 0; i < h->sig->in.len; i++ )
+    {
+        ch = h->sig->in.ports[i];
+        if( ch == NULL )
+            continue;
+        net = smx_net_create_internal( rts, "smx_dispatch", h->priority, 1,
+                group->count );
+        if( net == NULL )
+            goto error;
+        group->dispatchers[group->dispatch_count++] = net;
+        smx_net_init_dispatch( net, group->is_partitioned );
+        smx_connect_in( &net->sig->in.ports[0], ch, net, SMX_MODE_in,
+                &net->sig->in.count );
+        for( r = 0; r < group->count; r++ )
+        {
+            sprintf( cat_name, "ch_%s_%d", ch->name, rts->ch_cnt );
+            ch_replica = smx_channel_create( &rts->ch_cnt, ch->fifo->length,
+                    SMX_FIFO, rts->ch_cnt, ch->name, cat_name );
+            if( ch_replica == NULL )
+                goto error;
+            rts->chs[ch_replica->id] = ch_replica;
+            group->chs[group->ch_count++] = ch_replica;
+            smx_connect_out( &net->sig->out.ports[r], ch_replica, net,
+                    SMX_MODE_out, &net->sig->out.count );
+            ch_replica->source->net = group->replicas[r];
+            group->replicas[r]->sig->in.ports[i] = ch_replica;
+        }
+    }
+
+    for( i = 0; i < h->sig->out.len; i++ )
+    {
+        ch = h->sig->out.ports[i];
+        if( ch == NULL )
+            continue;
+        if( group->is_partitioned )
+        {
+            // the order among partitions is not defined: merge as it comes
+            net = smx_net_create_internal( rts, "smx_rn", h->priority,
+                    group->count, 1 );
+            if( net == NULL )
+                goto error;
+            smx_net_init_rn( net );
+        }
+        else
+        {
+            net = smx_net_create_internal( rts, "smx_merge", h->priority,
+                    group->count, 1 );
+            if( net == NULL )
+                goto error;
+        }
+        group->mergers[group->merge_count++] = net;
+        smx_connect_out( &net->sig->out.ports[0], ch, net, SMX_MODE_out,
+                &net->sig->out.count );
+        for( r = 0; r < group->count; r++ )
+        {
+            sprintf( cat_name, "ch_%s_%d", ch->name, rts->ch_cnt );
+            ch_replica = smx_channel_create( &rts->ch_cnt, ch->fifo->length,
+                    SMX_FIFO, rts->ch_cnt, ch->name, cat_name );
+            if( ch_replica == NULL )
+                goto error;
+            rts->chs[ch_replica->id] = ch_replica;
+            group->chs[group->ch_count++] = ch_replica;
+            smx_connect_in( &net->sig->in.ports[r], ch_replica, net,
+                    SMX_MODE_in, &net->sig->in.count );
+            if( group->is_partitioned )
+                smx_connect_rn( ch_replica, net );
+            ch_replica->sink->net = group->replicas[r];
+            group->replicas[r]->sig->out.ports[i] = ch_replica;
+        }
     }
-    SMX_LOG_NET( h, debug, "no configuration loaded from '%s'", search_str );
+
+    SMX_LOG_NET( h, notice, "net replicated %d times (%d dispatchers,"
+            " %d mergers, %s)", group->count, group->dispatch_count,
+            group->merge_count,
+            group->is_partitioned ? "partitioned" : "order-preserving" );
+    return 0;
+
+error:
+    SMX_LOG_NET( h, fatal, "failed to replicate net" );
+    smx_net_group_restore_ports( h );
+    smx_net_group_destroy( h );
     return -1;
 }
 
 /*****************************************************************************/
-const char* smx_net_get_string_prop( bson_t* conf, const char* name, const char* impl,
-        unsigned int id, const char* prop )
+void smx_net_group_destroy( smx_net_t* h )
 {
-    bson_iter_t iter;
-    bson_iter_t child;
-    char search_str[1000];
-    const char* nets = "_nets";
-    sprintf( search_str, "%s.%s.%s.%d.%s", nets, impl, name, id, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_UTF8( &child ) )
+    int i;
+    smx_net_group_t* group;
+
+    if( h == NULL || h->group == NULL )
+        return;
+
+    group = h->group;
+    h->group = NULL;
+    for( i = 1; i < group->count; i++ )
     {
-        return bson_iter_utf8( &child, NULL );
+        h->rts->nets[group->replicas[i]->id] = NULL;
+        smx_net_destroy( group->replicas[i] );
     }
-    sprintf( search_str, "%s.%s.%s._default.%s", nets, impl, name, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_UTF8( &child ) )
+    for( i = 0; i < group->dispatch_count; i++ )
     {
-        return bson_iter_utf8( &child, NULL );
+        h->rts->nets[group->dispatchers[i]->id] = NULL;
+        smx_net_destroy_dispatch( group->dispatchers[i] );
+        smx_net_destroy( group->dispatchers[i] );
     }
-    sprintf( search_str, "%s.%s._default.%s", nets, impl, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_UTF8( &child ) )
+    for( i = 0; i < group->merge_count; i++ )
     {
-        return bson_iter_utf8( &child, NULL );
+        h->rts->nets[group->mergers[i]->id] = NULL;
+        if( group->is_partitioned )
+            smx_net_destroy_rn( group->mergers[i] );
+        smx_net_destroy( group->mergers[i] );
     }
-    sprintf( search_str, "%s._default.%s", nets, prop );
-    if( bson_iter_init( &iter, conf )
-            && bson_iter_find_descendant( &iter, search_str, &child )
-            && BSON_ITER_HOLDS_UTF8( &child ) )
+    for( i = 0; i < group->ch_count; i++ )
     {
-        return bson_iter_utf8( &child, NULL );
+        h->rts->chs[group->chs[i]->id] = NULL;
+        smx_channel_destroy( group->chs[i] );
     }
+    if( group->replicas != NULL )
+        free( group->replicas );
+    if( group->dispatchers != NULL )
+        free( group->dispatchers );
+    if( group->mergers != NULL )
+        free( group->mergers );
+    if( group->chs != NULL )
+        free( group->chs );
+    free( group );
+}
 
-    return false;
+/*****************************************************************************/
+void smx_net_group_restore_ports( smx_net_t* h )
+{
+    int i, j;
+    smx_net_t* net;
+    smx_channel_t* ch;
+
+    if( h == NULL || h->group == NULL )
+        return;
+
+    // the first output of a dispatcher and the first input of a merger are
+    // connected to the original net
+    for( i = 0; i < h->group->dispatch_count; i++ )
+    {
+        net = h->group->dispatchers[i];
+        ch = net->sig->in.ports[0];
+        if( ch == NULL )
+            continue;
+        ch->source->net = h;
+        for( j = 0; j < h->sig->in.len; j++ )
+        {
+            if( h->sig->in.ports[j] != NULL
+                    && h->sig->in.ports[j] == net->sig->out.ports[0] )
+                h->sig->in.ports[j] = ch;
+        }
+    }
+    for( i = 0; i < h->group->merge_count; i++ )
+    {
+        net = h->group->mergers[i];
+        ch = net->sig->out.ports[0];
+        if( ch == NULL )
+            continue;
+        ch->sink->net = h;
+        for( j = 0; j < h->sig->out.len; j++ )
+        {
+            if( h->sig->out.ports[j] != NULL
+                    && h->sig->out.ports[j] == net->sig->in.ports[0] )
+                h->sig->out.ports[j] = ch;
+        }
+    }
+}
+
+/*****************************************************************************/
+int smx_net_group_run( pthread_t* ths, smx_net_t* h,
+        void* box_impl( void* arg ) )
+{
+    int i;
+    int rc = 0;
+    smx_net_group_t* group;
+
+    if( h == NULL || h->group == NULL )
+        return 0;
+
+    group = h->group;
+    for( i = 1; i < group->count; i++ )
+    {
+        if( smx_net_run( ths, group->replicas[i]->id, box_impl,
+                    group->replicas[i] ) < 0 )
+            rc = -1;
+    }
+    for( i = 0; i < group->dispatch_count; i++ )
+    {
+        if( smx_net_run( ths, group->dispatchers[i]->id,
+                    start_routine_smx_dispatch, group->dispatchers[i] ) < 0 )
+            rc = -1;
+    }
+    for( i = 0; i < group->merge_count; i++ )
+    {
+        if( smx_net_run( ths, group->mergers[i]->id,
+                    group->is_partitioned ? start_routine_smx_rn
+                        : start_routine_smx_merge, group->mergers[i] ) < 0 )
+            rc = -1;
+    }
+    return rc;
+}
+
+/*****************************************************************************/
+void smx_net_group_wait_end( pthread_t* ths, smx_net_t* h )
+{
+    int i;
+    smx_net_group_t* group;
+
+    if( h == NULL || h->group == NULL )
+        return;
+
+    group = h->group;
+    for( i = 1; i < group->count; i++ )
+        smx_net_wait_end( ths[group->replicas[i]->id] );
+    for( i = 0; i < group->dispatch_count; i++ )
+        smx_net_wait_end( ths[group->dispatchers[i]->id] );
+    for( i = 0; i < group->merge_count; i++ )
+        smx_net_wait_end( ths[group->mergers[i]->id] );
 }
 
 /*****************************************************************************/
@@ -393,6 +905,51 @@ void smx_net_init( smx_net_t* h, int indegree, int outdegree )
         h->sig->out.ports[i] = NULL;
 }
 
+/*****************************************************************************/
+void smx_net_init_channel_hists( smx_net_t* h )
+{
+    int i;
+    if( h == NULL || h->sig == NULL )
+        return;
+
+    if( !h->has_latency_hist && !h->has_queue_hist )
+        return;
+
+    for( i = 0; i < h->sig->in.len; i++ )
+    {
+        if( h->sig->in.ports[i] == NULL )
+            continue;
+        if( h->has_latency_hist )
+            smx_channel_set_latency_hist( h->sig->in.ports[i] );
+        if( h->has_queue_hist )
+            smx_channel_set_queue_hist( h->sig->in.ports[i] );
+    }
+}
+
+/*****************************************************************************/
+void smx_net_init_wake_moderation( smx_net_t* h )
+{
+    int i;
+    smx_channel_t* ch;
+    if( h == NULL || h->sig == NULL )
+        return;
+
+    if( h->wake_threshold <= 1 && h->wake_delay_us <= 0 )
+        return;
+
+    for( i = 0; i < h->sig->in.len; i++ )
+    {
+        ch = h->sig->in.ports[i];
+        // moderation has no effect on these channels, see
+        // smx_channel_wake_consumer()
+        if( ch == NULL || ch->collector != NULL || ch->type == SMX_RENDEZVOUS
+                || ch->type == SMX_FIFO_D || ch->type == SMX_D_FIFO_D )
+            continue;
+        smx_channel_set_wake_moderation( ch, h->wake_threshold,
+                h->wake_delay_us );
+    }
+}
+
 /*****************************************************************************/
 void smx_net_report_rate_warning( smx_net_t* h )
 {
@@ -460,7 +1017,15 @@ int smx_net_run( pthread_t* ths, int idx, void* box_impl( void* arg ), void* h )
     sprintf( id_str, "smx_net_%d", net->id );
     pthread_setname_np( thread, id_str );
     ths[idx] = thread;
-    return 0;
+    return smx_net_group_run( ths, net, box_impl );
+}
+
+/*****************************************************************************/
+void smx_net_set_conf( smx_net_t* h, bson_t* conf )
+{
+    h->conf = conf;
+    // invalidate all config handles of the net
+    h->conf_version++;
 }
 
 /*****************************************************************************/
@@ -481,6 +1046,10 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
     int state = SMX_NET_CONTINUE;
     int rc;
     int i;
+    struct timespec impl_start;
+    struct timespec impl_end;
+    struct timespec last_impl_start;
+    uint64_t impl_time;
     smx_channel_t* conf_port;
     smx_channel_err_t c_err;
     smx_msg_t* msg;
@@ -492,6 +1061,11 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
         return NULL;
     }
 
+    // create the log ring before the net loop such that logging does not
+    // allocate
+    if( smx_log_ring_thread_init() < 0 )
+        SMX_LOG_NET( h, warn, "failed to create log ring" );
+
     if( h->is_disabled )
     {
         SMX_LOG_NET( h, notice, "net was disabled through configuration" );
@@ -501,7 +1075,8 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
     }
 
     if( h->has_profiler )
-        SMX_LOG_NET( h, notice, "profiler enabled" );
+        SMX_LOG_NET( h, notice, "profiler enabled (mask 0x%02x)",
+                h->profiler_mask );
 
     if( h->shared_state_key == NULL )
     {
@@ -549,6 +1124,7 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
             if( rc < 0 )
             {
                 SMX_LOG_NET( h, error, "pre initialisation of net failed" );
+                pthread_mutex_unlock( &h->rts->net_mutex );
                 pthread_barrier_wait( &h->rts->pre_init_done );
                 pthread_barrier_wait( &h->rts->init_done );
                 goto smx_terminate_net;
@@ -600,7 +1176,7 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
             }
             SMX_LOG( h, debug, "received dynamic configuration: %s",
                     ( char* )msg->data );
-            h->conf = h->dyn_conf;
+            smx_net_set_conf( h, h->dyn_conf );
             SMX_LOG( h, notice, "dynamic configuration received and"
                     " successfully parsed" );
         }
@@ -630,9 +1206,10 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
     h->last_count_wall.tv_nsec = h->start_wall.tv_nsec;
     h->last_count_wall.tv_sec = h->start_wall.tv_sec;
     SMX_LOG_NET( h, notice, "start net" );
+    smx_metrics_set_net_state( h, SMX_METRICS_NET_RUN );
     while( state == SMX_NET_CONTINUE )
     {
-        smx_profiler_log_net( h, SMX_PROFILER_ACTION_NET_START );
+        SMX_PROFILER_LOG_NET( h, SMX_PROFILER_ACTION_NET_START );
         h->count++;
         SMX_LOG_NET( h, info, "start net loop %ld", h->count );
         if( ( h->expected_rate > 0 )
@@ -640,15 +1217,25 @@ void* smx_net_start_routine_with_shared_state( smx_net_t* h,
         {
             smx_net_report_rate_warning( h );
         }
-        smx_profiler_log_net( h, SMX_PROFILER_ACTION_NET_START_IMPL );
+        SMX_PROFILER_LOG_NET( h, SMX_PROFILER_ACTION_NET_START_IMPL );
+        clock_gettime( CLOCK_MONOTONIC, &impl_start );
+        if( h->count > 1 )
+            smx_hist_record( h->loop_hist, smx_get_elapsed_ns(
+                        &last_impl_start, &impl_start ) );
         state = impl( h, h->state );
-        smx_profiler_log_net( h, SMX_PROFILER_ACTION_NET_END_IMPL );
+        clock_gettime( CLOCK_MONOTONIC, &impl_end );
+        impl_time = smx_get_elapsed_ns( &impl_start, &impl_end );
+        smx_hist_record( h->impl_hist, impl_time );
+        smx_metrics_update_net( h, impl_time );
+        last_impl_start = impl_start;
+        SMX_PROFILER_LOG_NET( h, SMX_PROFILER_ACTION_NET_END_IMPL );
         state = smx_net_update_state( h, state );
-        smx_profiler_log_net( h, SMX_PROFILER_ACTION_NET_END );
+        SMX_PROFILER_LOG_NET( h, SMX_PROFILER_ACTION_NET_END );
     }
 
 smx_terminate_net:
     clock_gettime( CLOCK_MONOTONIC, &h->end_wall );
+    smx_metrics_set_net_state( h, SMX_METRICS_NET_END );
     smx_net_terminate( h );
     SMX_LOG_NET( h, notice, "cleanup net" );
     cleanup( h, h->state );
@@ -656,6 +1243,18 @@ smx_terminate_net:
     elapsed_wall += ( h->end_wall.tv_nsec - h->start_wall.tv_nsec) / 1000000000.0;
     SMX_LOG_NET( h, notice, "terminate net (loop count: %ld, loop rate: %d, wall time: %f)",
             h->count, (int)(h->count/elapsed_wall), elapsed_wall );
+    smx_hist_log( h->impl_hist, h->cat, "impl time" );
+    smx_hist_log( h->loop_hist, h->cat, "loop time" );
+    pthread_mutex_lock( &h->rts->net_mutex );
+    h->rts->net_end_cnt++;
+    if( h->rts->net_end_cnt == h->rts->net_cnt )
+    {
+        // the last net to terminate reports while all channels still exist
+        smx_channel_log_block_report( h->rts->chs, h->rts->ch_cnt,
+                SMX_CHANNEL_BLOCK_REPORT_COUNT );
+        smx_metrics_stop( h->rts->metrics );
+    }
+    pthread_mutex_unlock( &h->rts->net_mutex );
     return NULL;
 }
 
@@ -712,11 +1311,12 @@ int smx_net_update_state( smx_net_t* h, int state )
     {
         if( chs_in[i] == NULL ) continue;
         if( ( chs_in[i]->type == SMX_FIFO )
-                || ( chs_in[i]->type == SMX_D_FIFO ) )
+                || ( chs_in[i]->type == SMX_D_FIFO )
+                || ( chs_in[i]->type == SMX_RENDEZVOUS ) )
         {
             trigger_cnt++;
             if( ( chs_in[i]->source->state == SMX_CHANNEL_END )
-                    && ( chs_in[i]->fifo->count == 0 ) )
+                    && ( smx_channel_ready_to_read( chs_in[i] ) == 0 ) )
                 done_cnt_in++;
         }
     }
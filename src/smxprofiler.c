@@ -10,20 +10,67 @@
 
 #include <string.h>
 #include <time.h>
+#include "smxlog.h"
 #include "smxprofiler.h"
+#include "smxtracer.h"
 #include "smxutils.h"
 #include "lttng_tp.h"
 
-#define tracepoint_ch(action)\
-    tracepoint(smx_lttng, action, ch->id, net->id, ch->name, msg_id, val)
+// toggled by SMX_PROFILER_SIGNAL, pauses the profiler of all nets
+static volatile sig_atomic_t smx_profiler_is_paused = 0;
+
+// the built-in tracer replaces the LTTng tracepoints if it is enabled
+#define tracepoint_ch(action) do {\
+    if( net->tracer_ring == NULL )\
+        tracepoint(smx_lttng, action, ch->id, net->id, ch->name, msg_id, val);\
+    } while( 0 )
+
+/*****************************************************************************/
+unsigned int smx_profiler_get_mask( smx_net_t* net )
+{
+    if( net == NULL || smx_profiler_is_paused )
+        return 0;
+    return __atomic_load_n( &net->profiler_mask, __ATOMIC_RELAXED );
+}
+
+/*****************************************************************************/
+void smx_profiler_init_signal( smx_rts_t* rts )
+{
+    int i;
+    struct sigaction sa;
+
+    for( i = 0; i < rts->net_cnt; i++ )
+    {
+        if( rts->nets[i] != NULL && rts->nets[i]->has_profiler )
+            break;
+    }
+    if( i == rts->net_cnt )
+        return;
+
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sa_handler = smx_profiler_signal_handler;
+    sigemptyset( &sa.sa_mask );
+    sa.sa_flags = SA_RESTART;
+    if( sigaction( SMX_PROFILER_SIGNAL, &sa, NULL ) < 0 )
+    {
+        SMX_LOG_MAIN( main, error, "failed to install profiler signal handler" );
+        return;
+    }
+    SMX_LOG_MAIN( main, notice, "send signal %d to pause or resume the"
+            " profiler", SMX_PROFILER_SIGNAL );
+}
 
 /*****************************************************************************/
 void smx_profiler_log_ch( smx_net_t* net, smx_channel_t* ch, smx_msg_t* msg,
         smx_profiler_action_ch_t action, int val )
 {
-    if( net == NULL || !net->has_profiler || ch == NULL )
+    if( ch == NULL
+            || !( smx_profiler_get_mask( net ) & SMX_PROFILER_CH_CLASS( action ) )
+            || ( msg != NULL && !msg->is_traced ) )
         return;
     int msg_id = ( msg == NULL ) ? -1 : msg->id;
+    smx_tracer_write( net->tracer_ring, SMX_TRACER_EVENT_CH, action, net->id,
+            ch->id, msg_id, val );
     switch(action)
     {
         case SMX_PROFILER_ACTION_CH_READ:
@@ -80,15 +127,20 @@ void smx_profiler_log_ch( smx_net_t* net, smx_channel_t* ch, smx_msg_t* msg,
     }
 }
 
-#define tracepoint_msg(action)\
-    tracepoint(smx_lttng, action, msg->id, net->id)
+#define tracepoint_msg(action) do {\
+    if( net->tracer_ring == NULL )\
+        tracepoint(smx_lttng, action, msg->id, net->id);\
+    } while( 0 )
 
 /*****************************************************************************/
 void smx_profiler_log_msg( smx_net_t* net, smx_msg_t* msg,
         smx_profiler_action_msg_t action )
 {
-    if( net == NULL || !net->has_profiler || msg == NULL )
+    if( msg == NULL || !msg->is_traced
+            || !( smx_profiler_get_mask( net ) & SMX_PROFILER_CLASS_MSG ) )
         return;
+    smx_tracer_write( net->tracer_ring, SMX_TRACER_EVENT_MSG, action, net->id,
+            -1, msg->id, 0 );
     switch(action)
     {
         case SMX_PROFILER_ACTION_MSG_CREATE:
@@ -106,14 +158,18 @@ void smx_profiler_log_msg( smx_net_t* net, smx_msg_t* msg,
     }
 }
 
-#define tracepoint_net(action)\
-    tracepoint(smx_lttng, action, net->id, net->name)
+#define tracepoint_net(action) do {\
+    if( net->tracer_ring == NULL )\
+        tracepoint(smx_lttng, action, net->id, net->name);\
+    } while( 0 )
 
 /*****************************************************************************/
 void smx_profiler_log_net( smx_net_t* net, smx_profiler_action_net_t action )
 {
-    if( net == NULL || !net->has_profiler )
+    if( !( smx_profiler_get_mask( net ) & SMX_PROFILER_CLASS_NET ) )
         return;
+    smx_tracer_write( net->tracer_ring, SMX_TRACER_EVENT_NET, action, net->id,
+            -1, -1, 0 );
     switch(action)
     {
         case SMX_PROFILER_ACTION_NET_START:
@@ -130,3 +186,21 @@ void smx_profiler_log_net( smx_net_t* net, smx_profiler_action_net_t action )
             break;
     }
 }
+
+/*****************************************************************************/
+void smx_profiler_set_mask( void* h, unsigned int mask )
+{
+    smx_net_t* net = h;
+    if( net == NULL || !net->has_profiler )
+        return;
+    mask &= SMX_PROFILER_CLASS_ALL;
+    __atomic_store_n( &net->profiler_mask, mask, __ATOMIC_RELAXED );
+    SMX_LOG_NET( net, notice, "set profiler mask to 0x%02x", mask );
+}
+
+/*****************************************************************************/
+void smx_profiler_signal_handler( int sig )
+{
+    ( void )sig;
+    smx_profiler_is_paused = !smx_profiler_is_paused;
+}
@@ -8,6 +8,10 @@
  * The runtime system library for Streamix
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "smxrts.h"
 
 #define LIBZLOG_VERSION "1.2.14"
@@ -26,7 +30,11 @@ void smx_program_cleanup( smx_rts_t* rts )
         rts->shared_state[i]->cleanup( rts->shared_state[i]->state );
         free( rts->shared_state[i] );
     }
+    smx_tracer_destroy( rts->tracer );
+    smx_metrics_destroy( rts->metrics );
     pthread_mutex_destroy( &rts->net_mutex );
+    smx_net_conf_index_destroy( rts->net_conf_index );
+    smx_net_conf_files_destroy( rts->net_conf_files );
     bson_destroy( rts->conf );
     if( rts->args != NULL )
     {
@@ -50,9 +58,13 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
     int i, rc;
     bson_t tgt, payload, mapping;
     bson_iter_t i_map, i_maps;
-    pthread_mutexattr_t mutexattr_prioinherit;
     smx_config_data_maps_t maps;
     char* name = NULL;
+    struct timespec conf_start;
+    struct timespec conf_end;
+    const char* snapshot = getenv( SMX_SNAPSHOT_ENV );
+    uint64_t snapshot_hash = 0;
+    bool is_snapshot_loaded = false;
 
     rc = smx_log_init( log_conf );
     if( rc < 0 ) {
@@ -62,16 +74,32 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
 
     SMX_LOG_MAIN( main, notice, "using log configuration file '%s'", log_conf );
 
+    clock_gettime( CLOCK_MONOTONIC, &conf_start );
     bson_init( &tgt );
-    rc = smx_program_init_conf( app_conf, &tgt, &name );
-    if( rc < 0 )
+    if( snapshot != NULL && smx_program_init_snapshot_hash( app_conf,
+                app_conf_maps, app_conf_map_count, &snapshot_hash ) < 0 )
     {
-        goto error;
+        SMX_LOG_MAIN( main, warn, "failed to hash the configuration inputs,"
+                " ignoring config snapshot '%s'", snapshot );
+        snapshot = NULL;
+    }
+    if( snapshot != NULL )
+    {
+        is_snapshot_loaded = ( smx_program_init_snapshot_load( snapshot,
+                    snapshot_hash, &tgt, &name ) == 0 );
+    }
+    if( !is_snapshot_loaded )
+    {
+        rc = smx_program_init_conf( app_conf, &tgt, &name );
+        if( rc < 0 )
+        {
+            goto error;
+        }
     }
     SMX_LOG_MAIN( main, notice,
             "=============== Initializing app '%s' ===============", name );
 
-    for( i = 0; i < app_conf_map_count; i++ )
+    for( i = 0; !is_snapshot_loaded && i < app_conf_map_count; i++ )
     {
         bson_init( &mapping );
         rc = smx_program_init_maps( app_conf_maps[i], &mapping, &i_maps,
@@ -88,6 +116,9 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
             {
                 SMX_LOG_MAIN( main, fatal, "failed to init config map: %s",
                         smx_config_data_map_strerror( rc ) );
+                smx_hmap_destroy( maps.tgt_index, NULL );
+                free( maps.items );
+                bson_destroy( &maps.mapped_payload );
                 goto error_map;
             }
             rc = smx_config_data_maps_apply( &maps, &payload );
@@ -95,11 +126,15 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
             {
                 SMX_LOG_MAIN( main, fatal, "failed to apply config map: %s",
                         smx_config_data_map_strerror( rc ) );
+                smx_hmap_destroy( maps.tgt_index, NULL );
+                free( maps.items );
                 bson_destroy( &maps.mapped_payload );
                 goto error_map;
             }
             bson_destroy( &tgt );
             bson_copy_to( &maps.mapped_payload, &tgt );
+            smx_hmap_destroy( maps.tgt_index, NULL );
+            free( maps.items );
             bson_destroy( &maps.mapped_payload );
         }
         else
@@ -110,6 +145,10 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
         bson_destroy( &mapping );
         bson_destroy( &payload );
     }
+    if( snapshot != NULL && !is_snapshot_loaded )
+    {
+        smx_program_init_snapshot_write( snapshot, snapshot_hash, &tgt );
+    }
 
     smx_rts_t* rts = smx_malloc( sizeof( struct smx_rts_s ) );
     if( rts == NULL )
@@ -121,25 +160,48 @@ smx_rts_t* smx_program_init( const char* app_conf, const char* log_conf,
     rts->shared_state_cnt = 0;
     rts->ch_cnt = 0;
     rts->net_cnt = 0;
+    rts->net_end_cnt = 0;
     rts->start_wall.tv_sec = 0;
     rts->start_wall.tv_nsec = 0;
     rts->end_wall.tv_sec = 0;
     rts->end_wall.tv_nsec = 0;
     rts->conf = bson_copy( &tgt );
+    rts->net_conf_index = smx_net_conf_index_create( rts->conf );
+    if( rts->net_conf_index == NULL )
+    {
+        SMX_LOG_MAIN( main, fatal, "failed to index the net configuration" );
+        bson_destroy( rts->conf );
+        free( rts );
+        goto error;
+    }
+    clock_gettime( CLOCK_MONOTONIC, &conf_end );
+    SMX_LOG_MAIN( main, notice, "loaded app configuration with %d maps in"
+            " %.3f ms", app_conf_map_count,
+            smx_get_elapsed_ns( &conf_start, &conf_end ) / 1000000.0 );
+    rts->net_conf_files = smx_hmap_create( 16 );
+    if( rts->net_conf_files == NULL )
+    {
+        SMX_LOG_MAIN( main, fatal, "cannot create net config file cache" );
+        smx_net_conf_index_destroy( rts->net_conf_index );
+        bson_destroy( rts->conf );
+        free( rts );
+        goto error;
+    }
     rts->args = NULL;
 
     rc = smx_program_init_args( arg_str, arg_file, name, rts );
     if( rc < 0 )
     {
+        smx_net_conf_index_destroy( rts->net_conf_index );
+        smx_net_conf_files_destroy( rts->net_conf_files );
         bson_destroy( rts->conf );
         free( rts );
         goto error;
     }
+    rts->tracer = smx_tracer_create( rts->conf );
+    rts->metrics = smx_metrics_create( rts->conf );
 
-    pthread_mutexattr_init( &mutexattr_prioinherit );
-    pthread_mutexattr_setprotocol( &mutexattr_prioinherit,
-            PTHREAD_PRIO_INHERIT );
-    pthread_mutex_init( &rts->net_mutex, &mutexattr_prioinherit );
+    smx_mutex_init( &rts->net_mutex, true );
     clock_gettime( CLOCK_MONOTONIC, &rts->start_wall );
 
     SMX_LOG_MAIN( main, notice, "using libsmxrts version: %s",
@@ -336,9 +398,87 @@ error:
     return -1;
 }
 
+/*****************************************************************************/
+void smx_program_init_mutex( smx_rts_t* rts )
+{
+    int i, j;
+    int rt_cnt = 0;
+    bool is_rt;
+    bool has_rt = false;
+    smx_net_t* net;
+
+    for( i = 0; i < rts->ch_cnt; i++ )
+    {
+        if( rts->chs[i] == NULL )
+            continue;
+        is_rt = smx_channel_is_rt( rts->chs[i] );
+        smx_channel_init_mutex( rts->chs[i], is_rt );
+        if( is_rt )
+            rt_cnt++;
+    }
+
+    for( i = 0; i < rts->net_cnt; i++ )
+    {
+        net = rts->nets[i];
+        if( net == NULL )
+            continue;
+        if( net->priority > 0 )
+            has_rt = true;
+        if( !net->is_rn || net->attr == NULL )
+            continue;
+        // the collector of a routing node is shared by all input channels
+        is_rt = false;
+        for( j = 0; j < net->sig->in.len; j++ )
+        {
+            if( smx_channel_is_rt( net->sig->in.ports[j] ) )
+                is_rt = true;
+        }
+        smx_collector_init_mutex( net->attr, is_rt );
+    }
+
+    pthread_mutex_destroy( &rts->net_mutex );
+    smx_mutex_init( &rts->net_mutex, has_rt );
+    smx_log_init_mutex( has_rt );
+
+    SMX_LOG_MAIN( main, notice, "using priority inheritance mutexes on %d of"
+            " %d channels", rt_cnt, rts->ch_cnt );
+}
+
 /*****************************************************************************/
 void smx_program_init_run( smx_rts_t* rts )
 {
+    int i;
+    int net_cnt = rts->net_cnt;
+
+    for( i = 0; i < net_cnt; i++ )
+    {
+        if( smx_net_group_create( rts->nets[i] ) < 0 )
+        {
+            SMX_LOG_MAIN( main, fatal, "failed to replicate net %d", i );
+            smx_log_cleanup();
+            exit( 0 );
+        }
+    }
+    for( i = 0; i < rts->net_cnt; i++ )
+    {
+        smx_net_init_wake_moderation( rts->nets[i] );
+        smx_net_init_channel_hists( rts->nets[i] );
+    }
+    smx_program_init_mutex( rts );
+    smx_profiler_init_signal( rts );
+    if( smx_tracer_start( rts->tracer, rts ) < 0 )
+    {
+        SMX_LOG_MAIN( main, fatal, "failed to start tracer" );
+        smx_log_cleanup();
+        exit( 0 );
+    }
+    if( smx_metrics_start( rts->metrics, rts ) < 0 )
+    {
+        SMX_LOG_MAIN( main, fatal, "failed to publish metrics" );
+        smx_log_cleanup();
+        exit( 0 );
+    }
+
     SMX_LOG_MAIN( main, notice, "waiting for all %d nets to finish"
             " initialisation", rts->net_cnt );
     if( pthread_barrier_init( &rts->pre_init_done, NULL, rts->net_cnt ) != 0 )
@@ -351,6 +491,167 @@ void smx_program_init_run( smx_rts_t* rts )
     }
 }
 
+/*****************************************************************************/
+int smx_program_init_snapshot_hash( const char* app_conf,
+        const char** app_conf_maps, int app_conf_map_count, uint64_t* hash )
+{
+    int i;
+
+    *hash = smx_hash_bytes( SMX_HASH_INIT, LIBSMXRTS_VERSION,
+            strlen( LIBSMXRTS_VERSION ) + 1 );
+    if( smx_program_init_snapshot_hash_file( app_conf, hash ) < 0 )
+        return -1;
+    for( i = 0; i < app_conf_map_count; i++ )
+    {
+        if( smx_program_init_snapshot_hash_file( app_conf_maps[i], hash ) < 0 )
+            return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_program_init_snapshot_hash_file( const char* path, uint64_t* hash )
+{
+    char buf[4096];
+    size_t len;
+    uint64_t size = 0;
+    FILE* f = fopen( path, "r" );
+    if( f == NULL )
+    {
+        SMX_LOG_MAIN( main, error, "failed to open file '%s': %s", path,
+                strerror( errno ) );
+        return -1;
+    }
+
+    *hash = smx_hash_bytes( *hash, path, strlen( path ) + 1 );
+    while( ( len = fread( buf, 1, sizeof( buf ), f ) ) > 0 )
+    {
+        *hash = smx_hash_bytes( *hash, buf, len );
+        size += len;
+    }
+    // separate the content of consecutive files
+    *hash = smx_hash_bytes( *hash, &size, sizeof( size ) );
+    fclose( f );
+
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_program_init_snapshot_load( const char* path, uint64_t hash,
+        bson_t* doc, char** name )
+{
+    int fd;
+    struct stat st;
+    uint8_t* map;
+    smx_snapshot_header_t* header;
+    bson_t snapshot;
+    bson_iter_t iter;
+
+    fd = open( path, O_RDONLY );
+    if( fd < 0 )
+    {
+        SMX_LOG_MAIN( main, notice, "no config snapshot '%s' available",
+                path );
+        return -1;
+    }
+    if( fstat( fd, &st ) < 0
+            || ( size_t )st.st_size < sizeof( struct smx_snapshot_header_s ) )
+    {
+        SMX_LOG_MAIN( main, warn, "config snapshot '%s' is not valid", path );
+        close( fd );
+        return -1;
+    }
+    map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED )
+    {
+        SMX_LOG_MAIN( main, warn, "failed to map config snapshot '%s': %s",
+                path, strerror( errno ) );
+        return -1;
+    }
+
+    header = ( smx_snapshot_header_t* )map;
+    if( memcmp( header->magic, SMX_SNAPSHOT_MAGIC, sizeof( header->magic ) )
+                != 0
+            || header->version != SMX_SNAPSHOT_VERSION
+            || ( size_t )st.st_size != sizeof( struct smx_snapshot_header_s )
+                + header->size
+            || !bson_init_static( &snapshot, map + sizeof( *header ),
+                header->size )
+            || !bson_validate( &snapshot, BSON_VALIDATE_NONE, NULL ) )
+    {
+        SMX_LOG_MAIN( main, warn, "config snapshot '%s' is not valid", path );
+        munmap( map, st.st_size );
+        return -1;
+    }
+    if( header->hash != hash )
+    {
+        SMX_LOG_MAIN( main, notice, "config snapshot '%s' is outdated", path );
+        munmap( map, st.st_size );
+        return -1;
+    }
+    if( !bson_iter_init_find( &iter, &snapshot, "_name" )
+            || !BSON_ITER_HOLDS_UTF8( &iter ) )
+    {
+        SMX_LOG_MAIN( main, warn, "missing mandatory key '_name' in config"
+                " snapshot '%s'", path );
+        munmap( map, st.st_size );
+        return -1;
+    }
+
+    *name = bson_iter_dup_utf8( &iter, NULL );
+    bson_destroy( doc );
+    bson_copy_to( &snapshot, doc );
+    munmap( map, st.st_size );
+    SMX_LOG_MAIN( main, notice, "loaded config snapshot '%s'", path );
+
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_program_init_snapshot_write( const char* path, uint64_t hash,
+        bson_t* doc )
+{
+    char tmp_path[1000];
+    FILE* f;
+    smx_snapshot_header_t header;
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, SMX_SNAPSHOT_MAGIC, sizeof( header.magic ) );
+    header.version = SMX_SNAPSHOT_VERSION;
+    header.size = doc->len;
+    header.hash = hash;
+
+    snprintf( tmp_path, sizeof( tmp_path ), "%s.tmp", path );
+    f = fopen( tmp_path, "wb" );
+    if( f == NULL )
+    {
+        SMX_LOG_MAIN( main, error, "failed to open file '%s': %s", tmp_path,
+                strerror( errno ) );
+        return -1;
+    }
+    if( fwrite( &header, sizeof( header ), 1, f ) != 1
+            || fwrite( bson_get_data( doc ), 1, doc->len, f ) != doc->len )
+    {
+        SMX_LOG_MAIN( main, error, "failed to write config snapshot '%s': %s",
+                tmp_path, strerror( errno ) );
+        fclose( f );
+        unlink( tmp_path );
+        return -1;
+    }
+    if( fclose( f ) != 0 || rename( tmp_path, path ) < 0 )
+    {
+        SMX_LOG_MAIN( main, error, "failed to write config snapshot '%s': %s",
+                path, strerror( errno ) );
+        unlink( tmp_path );
+        return -1;
+    }
+    SMX_LOG_MAIN( main, notice, "wrote config snapshot '%s'", path );
+
+    return 0;
+}
+
 /******************************************************************************/
 const char* smx_rts_get_version()
 {
@@ -0,0 +1,652 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Built-in binary tracer for the runtime system library of Streamix
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "smxtracer.h"
+#include "smxlog.h"
+#include "smxutils.h"
+
+/*****************************************************************************/
+smx_tracer_t* smx_tracer_create( bson_t* conf )
+{
+    bson_iter_t iter;
+    bson_iter_t child;
+    struct timespec ts;
+    smx_tracer_header_t* header;
+    smx_tracer_t* tracer;
+
+    if( !( bson_iter_init_find( &iter, conf, "_tracer" )
+            && BSON_ITER_HOLDS_DOCUMENT( &iter ) ) )
+        return NULL;
+
+    tracer = smx_malloc( sizeof( struct smx_tracer_s ) );
+    if( tracer == NULL )
+        return NULL;
+
+    tracer->path = NULL;
+    tracer->fd = -1;
+    tracer->map = NULL;
+    tracer->capacity = 0;
+    tracer->ring_size = SMX_TRACER_RING_SIZE;
+    tracer->ring_count = 0;
+    tracer->rings = NULL;
+    tracer->flush_interval_ms = SMX_TRACER_FLUSH_INTERVAL_MS;
+    tracer->is_running = false;
+    tracer->chrome_path = NULL;
+    tracer->net_count = 0;
+    tracer->net_names = NULL;
+    tracer->ch_count = 0;
+    tracer->ch_names = NULL;
+
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "path" )
+            && BSON_ITER_HOLDS_UTF8( &child ) )
+    {
+        tracer->path = bson_iter_dup_utf8( &child, NULL );
+    }
+    else
+    {
+        SMX_LOG_MAIN( main, error,
+                "missing mandatory key '_tracer.path' in app config" );
+        goto error;
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "ring_size" )
+            && BSON_ITER_HOLDS_INT32( &child ) )
+    {
+        tracer->ring_size = bson_iter_int32( &child );
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "flush_interval_ms" )
+            && BSON_ITER_HOLDS_INT32( &child ) )
+    {
+        tracer->flush_interval_ms = bson_iter_int32( &child );
+    }
+    if( bson_iter_recurse( &iter, &child )
+            && bson_iter_find( &child, "chrome_path" )
+            && BSON_ITER_HOLDS_UTF8( &child ) )
+    {
+        tracer->chrome_path = bson_iter_dup_utf8( &child, NULL );
+    }
+
+    tracer->fd = open( tracer->path, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if( tracer->fd < 0 )
+    {
+        SMX_LOG_MAIN( main, error, "failed to open trace file '%s': %s",
+                tracer->path, strerror( errno ) );
+        goto error;
+    }
+    if( smx_tracer_grow( tracer, SMX_TRACER_FILE_CHUNK ) < 0 )
+        goto error;
+
+    header = ( smx_tracer_header_t* )tracer->map;
+    memset( header, 0, sizeof( struct smx_tracer_header_s ) );
+    memcpy( header->magic, SMX_TRACER_MAGIC, sizeof( header->magic ) );
+    header->version = SMX_TRACER_VERSION;
+    header->event_size = sizeof( struct smx_tracer_event_s );
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    header->start_ts = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    clock_gettime( CLOCK_REALTIME, &ts );
+    header->start_real_ts = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    SMX_LOG_MAIN( main, notice, "using built-in tracer, writing to '%s'",
+            tracer->path );
+    return tracer;
+
+error:
+    smx_tracer_destroy( tracer );
+    return NULL;
+}
+
+/*****************************************************************************/
+void smx_tracer_destroy( smx_tracer_t* tracer )
+{
+    int i;
+    smx_tracer_header_t* header;
+
+    if( tracer == NULL )
+        return;
+
+    if( tracer->is_running )
+    {
+        __atomic_store_n( &tracer->is_running, false, __ATOMIC_RELEASE );
+        pthread_join( tracer->th, NULL );
+    }
+
+    if( tracer->map != NULL )
+    {
+        smx_tracer_flush( tracer );
+        header = ( smx_tracer_header_t* )tracer->map;
+        for( i = 0; i < tracer->ring_count; i++ )
+            header->drop_count += tracer->rings[i]->drop_count;
+        SMX_LOG_MAIN( main, notice, "tracer wrote %lu events to '%s'"
+                " (%lu dropped)", header->event_count, tracer->path,
+                header->drop_count );
+        if( header->drop_count > 0 )
+        {
+            SMX_LOG_MAIN( main, warn, "tracer rings overflowed, consider"
+                    " increasing '_tracer.ring_size' (%d)",
+                    tracer->ring_size );
+        }
+        if( tracer->chrome_path != NULL
+                && smx_tracer_export_chrome( tracer, tracer->chrome_path ) == 0 )
+        {
+            SMX_LOG_MAIN( main, notice, "exported trace to '%s'",
+                    tracer->chrome_path );
+        }
+        msync( tracer->map, sizeof( struct smx_tracer_header_s )
+                + tracer->capacity * sizeof( struct smx_tracer_event_s ),
+                MS_SYNC );
+        if( ftruncate( tracer->fd, sizeof( struct smx_tracer_header_s )
+                    + header->event_count
+                    * sizeof( struct smx_tracer_event_s ) ) < 0 )
+        {
+            SMX_LOG_MAIN( main, error, "failed to truncate trace file: %s",
+                    strerror( errno ) );
+        }
+        munmap( tracer->map, sizeof( struct smx_tracer_header_s )
+                + tracer->capacity * sizeof( struct smx_tracer_event_s ) );
+    }
+    if( tracer->fd >= 0 )
+        close( tracer->fd );
+    for( i = 0; i < tracer->ring_count; i++ )
+        smx_tracer_ring_destroy( tracer->rings[i] );
+    if( tracer->rings != NULL )
+        free( tracer->rings );
+    for( i = 0; i < tracer->net_count; i++ )
+        if( tracer->net_names[i] != NULL )
+            free( tracer->net_names[i] );
+    if( tracer->net_names != NULL )
+        free( tracer->net_names );
+    for( i = 0; i < tracer->ch_count; i++ )
+        if( tracer->ch_names[i] != NULL )
+            free( tracer->ch_names[i] );
+    if( tracer->ch_names != NULL )
+        free( tracer->ch_names );
+    if( tracer->chrome_path != NULL )
+        free( tracer->chrome_path );
+    if( tracer->path != NULL )
+        free( tracer->path );
+    free( tracer );
+}
+
+/*****************************************************************************/
+const char* smx_tracer_action_str( smx_tracer_event_type_t type, int action )
+{
+    const char* ch_actions[] = { "ch_read", "ch_read_block",
+        "ch_read_collector", "ch_read_collector_block", "ch_write",
+        "ch_write_block", "ch_write_collector", "ch_overwrite", "ch_dismiss",
+        "ch_duplicate", "ch_dl_miss_src", "ch_dl_miss_src_cp",
+        "ch_tt_miss_src", "ch_tt_miss_src_cp", "ch_dl_miss_sink",
+        "ch_tt_miss_sink" };
+    const char* msg_actions[] = { "msg_create", "msg_destroy",
+        "msg_copy_start", "msg_copy_end" };
+    const char* net_actions[] = { "net_start", "net_start_impl",
+        "net_end_impl", "net_end" };
+    const char* unknown = "unknown";
+
+    switch( type )
+    {
+        case SMX_TRACER_EVENT_CH:
+            if( action >= 0 && action <= SMX_PROFILER_ACTION_CH_TT_MISS_SINK )
+                return ch_actions[action];
+            break;
+        case SMX_TRACER_EVENT_MSG:
+            if( action >= 0 && action <= SMX_PROFILER_ACTION_MSG_COPY_END )
+                return msg_actions[action];
+            break;
+        case SMX_TRACER_EVENT_NET:
+            if( action >= 0 && action <= SMX_PROFILER_ACTION_NET_END )
+                return net_actions[action];
+            break;
+    }
+    return unknown;
+}
+
+/*****************************************************************************/
+int smx_tracer_export_chrome( smx_tracer_t* tracer, const char* path )
+{
+    FILE* f;
+    uint64_t i;
+    int j;
+    double ts;
+    double block_ts;
+    uint64_t last_ts = 0;
+    const char* sep = "";
+    const char* ch_name;
+    smx_tracer_header_t* header;
+    smx_tracer_event_t* events;
+    smx_tracer_event_t* ev;
+    smx_tracer_event_t** blocks;
+
+    if( tracer == NULL || tracer->map == NULL )
+        return -1;
+
+    f = fopen( path, "w" );
+    if( f == NULL )
+    {
+        SMX_LOG_MAIN( main, error, "failed to open trace export file '%s': %s",
+                path, strerror( errno ) );
+        return -1;
+    }
+    // the pending blocking event of each net
+    blocks = smx_malloc( sizeof( smx_tracer_event_t* ) * tracer->net_count );
+    if( blocks == NULL )
+    {
+        fclose( f );
+        return -1;
+    }
+    for( j = 0; j < tracer->net_count; j++ )
+        blocks[j] = NULL;
+
+    header = ( smx_tracer_header_t* )tracer->map;
+    events = ( smx_tracer_event_t* )( tracer->map
+            + sizeof( struct smx_tracer_header_s ) );
+
+    fprintf( f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" );
+    fprintf( f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"args\":{\"name\":\"streamix\"}}" );
+    sep = ",\n";
+    for( j = 0; j < tracer->net_count; j++ )
+    {
+        if( tracer->net_names[j] == NULL )
+            continue;
+        fprintf( f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%d,\"args\":{\"name\":\"", sep, j );
+        smx_tracer_export_str( f, tracer->net_names[j] );
+        fprintf( f, "(%d)\"}}", j );
+    }
+
+    for( i = 0; i < header->event_count; i++ )
+    {
+        ev = &events[i];
+        if( ev->net_id < 0 || ev->net_id >= tracer->net_count )
+            continue;
+        ts = ( ev->ts - header->start_ts ) / 1000.0;
+        if( ev->ts > last_ts )
+            last_ts = ev->ts;
+        ch_name = ( ev->ch_id >= 0 && ev->ch_id < tracer->ch_count )
+            ? tracer->ch_names[ev->ch_id] : NULL;
+
+        // a blocking period ends with the next event of the same net
+        if( blocks[ev->net_id] != NULL
+                && !( ev->type == SMX_TRACER_EVENT_CH
+                    && ev->action == blocks[ev->net_id]->action
+                    && ev->ch_id == blocks[ev->net_id]->ch_id ) )
+        {
+            block_ts = ( blocks[ev->net_id]->ts - header->start_ts ) / 1000.0;
+            fprintf( f, "%s{\"name\":\"%s ", sep, smx_tracer_action_str(
+                        SMX_TRACER_EVENT_CH, blocks[ev->net_id]->action ) );
+            smx_tracer_export_str( f, ( blocks[ev->net_id]->ch_id >= 0
+                        && blocks[ev->net_id]->ch_id < tracer->ch_count )
+                    ? tracer->ch_names[blocks[ev->net_id]->ch_id] : NULL );
+            fprintf( f, "\",\"cat\":\"block\",\"ph\":\"X\",\"pid\":1,"
+                    "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ev->net_id,
+                    block_ts, ts - block_ts );
+            blocks[ev->net_id] = NULL;
+        }
+
+        switch( ev->type )
+        {
+            case SMX_TRACER_EVENT_NET:
+                fprintf( f, "%s{\"name\":\"", sep );
+                if( ev->action == SMX_PROFILER_ACTION_NET_START
+                        || ev->action == SMX_PROFILER_ACTION_NET_END )
+                    fprintf( f, "loop" );
+                else
+                    smx_tracer_export_str( f, tracer->net_names[ev->net_id] );
+                fprintf( f, "\",\"cat\":\"net\",\"ph\":\"%s\",\"pid\":1,"
+                        "\"tid\":%d,\"ts\":%.3f}",
+                        ( ev->action == SMX_PROFILER_ACTION_NET_START
+                          || ev->action == SMX_PROFILER_ACTION_NET_START_IMPL )
+                        ? "B" : "E", ev->net_id, ts );
+                break;
+            case SMX_TRACER_EVENT_MSG:
+                if( ev->action == SMX_PROFILER_ACTION_MSG_COPY_START
+                        || ev->action == SMX_PROFILER_ACTION_MSG_COPY_END )
+                    fprintf( f, "%s{\"name\":\"msg_copy\",\"ph\":\"%s\"",
+                            sep, ( ev->action
+                                == SMX_PROFILER_ACTION_MSG_COPY_START )
+                            ? "B" : "E" );
+                else
+                    fprintf( f, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\"",
+                            sep, smx_tracer_action_str( ev->type,
+                                ev->action ) );
+                fprintf( f, ",\"cat\":\"msg\",\"pid\":1,\"tid\":%d,"
+                        "\"ts\":%.3f,\"args\":{\"msg\":%ld}}", ev->net_id,
+                        ts, ( long )ev->msg_id );
+                break;
+            case SMX_TRACER_EVENT_CH:
+                if( ev->action == SMX_PROFILER_ACTION_CH_READ_BLOCK
+                        || ev->action == SMX_PROFILER_ACTION_CH_WRITE_BLOCK
+                        || ev->action
+                            == SMX_PROFILER_ACTION_CH_READ_COLLECTOR_BLOCK )
+                {
+                    // a blocked wait may log several block events
+                    if( blocks[ev->net_id] == NULL )
+                        blocks[ev->net_id] = ev;
+                    break;
+                }
+                fprintf( f, "%s{\"name\":\"%s ", sep,
+                        smx_tracer_action_str( ev->type, ev->action ) );
+                smx_tracer_export_str( f, ch_name );
+                fprintf( f, "\",\"cat\":\"ch\",\"ph\":\"i\",\"s\":\"t\","
+                        "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{"
+                        "\"msg\":%ld,\"count\":%d}}", ev->net_id, ts,
+                        ( long )ev->msg_id, ev->val );
+                if( ev->action == SMX_PROFILER_ACTION_CH_READ
+                        || ev->action == SMX_PROFILER_ACTION_CH_WRITE )
+                {
+                    // the fill level of the channel
+                    fprintf( f, "%s{\"name\":\"", sep );
+                    smx_tracer_export_str( f, ch_name );
+                    fprintf( f, "(%d)\",\"cat\":\"ch\",\"ph\":\"C\","
+                            "\"pid\":1,\"ts\":%.3f,\"args\":{"
+                            "\"count\":%d}}", ev->ch_id, ts, ev->val );
+                }
+                break;
+        }
+    }
+
+    // nets which are still blocked at the end of the trace
+    for( j = 0; j < tracer->net_count; j++ )
+    {
+        if( blocks[j] == NULL )
+            continue;
+        block_ts = ( blocks[j]->ts - header->start_ts ) / 1000.0;
+        fprintf( f, "%s{\"name\":\"%s ", sep, smx_tracer_action_str(
+                    SMX_TRACER_EVENT_CH, blocks[j]->action ) );
+        smx_tracer_export_str( f, ( blocks[j]->ch_id >= 0
+                    && blocks[j]->ch_id < tracer->ch_count )
+                ? tracer->ch_names[blocks[j]->ch_id] : NULL );
+        fprintf( f, "\",\"cat\":\"block\",\"ph\":\"X\",\"pid\":1,"
+                "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", j, block_ts,
+                ( last_ts - header->start_ts ) / 1000.0 - block_ts );
+    }
+
+    fprintf( f, "\n]}\n" );
+    free( blocks );
+    if( fclose( f ) != 0 )
+    {
+        SMX_LOG_MAIN( main, error, "failed to write trace export file '%s'",
+                path );
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_tracer_export_str( FILE* f, const char* str )
+{
+    if( str == NULL )
+        return;
+
+    while( *str != '\0' )
+    {
+        switch( *str )
+        {
+            case '"':
+                fputs( "\\\"", f );
+                break;
+            case '\\':
+                fputs( "\\\\", f );
+                break;
+            case '\n':
+                fputs( "\\n", f );
+                break;
+            case '\r':
+                fputs( "\\r", f );
+                break;
+            case '\t':
+                fputs( "\\t", f );
+                break;
+            default:
+                if( ( unsigned char )*str < 0x20 )
+                    fprintf( f, "\\u%04x", ( unsigned char )*str );
+                else
+                    fputc( *str, f );
+        }
+        str++;
+    }
+}
+
+/*****************************************************************************/
+int smx_tracer_flush( smx_tracer_t* tracer )
+{
+    int i;
+    int count = 0;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t n;
+    uint64_t idx;
+    uint64_t chunk;
+    smx_tracer_ring_t* ring;
+    smx_tracer_header_t* header;
+    smx_tracer_event_t* events;
+
+    if( tracer == NULL || tracer->map == NULL )
+        return -1;
+
+    for( i = 0; i < tracer->ring_count; i++ )
+    {
+        ring = tracer->rings[i];
+        head = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+        tail = ring->tail;
+        n = head - tail;
+        if( n == 0 )
+            continue;
+
+        header = ( smx_tracer_header_t* )tracer->map;
+        if( header->event_count + n > tracer->capacity
+                && smx_tracer_grow( tracer, header->event_count + n ) < 0 )
+            return -1;
+        // the mapping may have moved
+        header = ( smx_tracer_header_t* )tracer->map;
+        events = ( smx_tracer_event_t* )( tracer->map
+                + sizeof( struct smx_tracer_header_s ) );
+
+        // copy in at most two chunks because the ring wraps around
+        while( tail != head )
+        {
+            idx = tail & ring->mask;
+            chunk = SMX_MIN( head - tail, ring->mask + 1 - idx );
+            memcpy( &events[header->event_count], &ring->events[idx],
+                    chunk * sizeof( struct smx_tracer_event_s ) );
+            header->event_count += chunk;
+            tail += chunk;
+        }
+        __atomic_store_n( &ring->tail, tail, __ATOMIC_RELEASE );
+        count += n;
+    }
+    return count;
+}
+
+/*****************************************************************************/
+int smx_tracer_grow( smx_tracer_t* tracer, size_t count )
+{
+    size_t capacity = tracer->capacity;
+    size_t old_size = sizeof( struct smx_tracer_header_s )
+        + capacity * sizeof( struct smx_tracer_event_s );
+    size_t new_size;
+    uint8_t* map;
+
+    while( capacity < count )
+        capacity += SMX_TRACER_FILE_CHUNK;
+    new_size = sizeof( struct smx_tracer_header_s )
+        + capacity * sizeof( struct smx_tracer_event_s );
+
+    if( ftruncate( tracer->fd, new_size ) < 0 )
+    {
+        SMX_LOG_MAIN( main, error, "failed to grow trace file: %s",
+                strerror( errno ) );
+        return -1;
+    }
+    if( tracer->map == NULL )
+        map = mmap( NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                tracer->fd, 0 );
+    else
+        map = mremap( tracer->map, old_size, new_size, MREMAP_MAYMOVE );
+    if( map == MAP_FAILED )
+    {
+        SMX_LOG_MAIN( main, error, "failed to map trace file: %s",
+                strerror( errno ) );
+        return -1;
+    }
+    tracer->map = map;
+    tracer->capacity = capacity;
+    return 0;
+}
+
+/*****************************************************************************/
+smx_tracer_ring_t* smx_tracer_ring_create( int size, int net_id )
+{
+    uint64_t len = 1;
+    smx_tracer_ring_t* ring;
+
+    while( len < ( uint64_t )size )
+        len <<= 1;
+
+    if( posix_memalign( ( void** )&ring, 64,
+                sizeof( struct smx_tracer_ring_s ) ) != 0 )
+    {
+        SMX_LOG_MAIN( main, fatal, "failed to allocate tracer ring" );
+        return NULL;
+    }
+    ring->events = smx_malloc( len * sizeof( struct smx_tracer_event_s ) );
+    if( ring->events == NULL )
+    {
+        free( ring );
+        return NULL;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    ring->drop_count = 0;
+    ring->mask = len - 1;
+    ring->net_id = net_id;
+    return ring;
+}
+
+/*****************************************************************************/
+void smx_tracer_ring_destroy( smx_tracer_ring_t* ring )
+{
+    if( ring == NULL )
+        return;
+
+    free( ring->events );
+    free( ring );
+}
+
+/*****************************************************************************/
+void* smx_tracer_run( void* tracer )
+{
+    smx_tracer_t* t = tracer;
+    struct timespec ts;
+
+    ts.tv_sec = t->flush_interval_ms / 1000;
+    ts.tv_nsec = ( t->flush_interval_ms % 1000 ) * 1000000;
+    while( __atomic_load_n( &t->is_running, __ATOMIC_ACQUIRE ) )
+    {
+        nanosleep( &ts, NULL );
+        if( smx_tracer_flush( t ) < 0 )
+        {
+            SMX_LOG_MAIN( main, error, "tracer flush failed, stop tracing" );
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*****************************************************************************/
+int smx_tracer_start( smx_tracer_t* tracer, smx_rts_t* rts )
+{
+    int i;
+    smx_net_t* net;
+
+    if( tracer == NULL )
+        return 0;
+
+    tracer->rings = smx_malloc( sizeof( smx_tracer_ring_t* ) * rts->net_cnt );
+    tracer->net_names = smx_malloc( sizeof( char* ) * rts->net_cnt );
+    tracer->ch_names = smx_malloc( sizeof( char* ) * rts->ch_cnt );
+    if( tracer->rings == NULL || tracer->net_names == NULL
+            || tracer->ch_names == NULL )
+        return -1;
+
+    // the nets and channels are destroyed before the trace is exported
+    tracer->net_count = rts->net_cnt;
+    for( i = 0; i < rts->net_cnt; i++ )
+        tracer->net_names[i] = ( rts->nets[i] == NULL
+                || rts->nets[i]->name == NULL )
+            ? NULL : strdup( rts->nets[i]->name );
+    tracer->ch_count = rts->ch_cnt;
+    for( i = 0; i < rts->ch_cnt; i++ )
+        tracer->ch_names[i] = ( rts->chs[i] == NULL
+                || rts->chs[i]->name == NULL )
+            ? NULL : strdup( rts->chs[i]->name );
+
+    for( i = 0; i < rts->net_cnt; i++ )
+    {
+        net = rts->nets[i];
+        if( net == NULL || !net->has_profiler )
+            continue;
+        net->tracer_ring = smx_tracer_ring_create( tracer->ring_size,
+                net->id );
+        if( net->tracer_ring == NULL )
+            return -1;
+        tracer->rings[tracer->ring_count++] = net->tracer_ring;
+    }
+
+    tracer->is_running = true;
+    if( pthread_create( &tracer->th, NULL, smx_tracer_run, tracer ) != 0 )
+    {
+        tracer->is_running = false;
+        SMX_LOG_MAIN( main, error, "failed to create tracer thread" );
+        return -1;
+    }
+    SMX_LOG_MAIN( main, notice, "tracing %d nets", tracer->ring_count );
+    return 0;
+}
+
+/*****************************************************************************/
+void smx_tracer_write( smx_tracer_ring_t* ring, smx_tracer_event_type_t type,
+        int action, int net_id, int ch_id, int64_t msg_id, int val )
+{
+    struct timespec ts;
+    uint64_t head;
+    smx_tracer_event_t* event;
+
+    if( ring == NULL )
+        return;
+
+    head = ring->head;
+    if( head - __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE ) > ring->mask )
+    {
+        ring->drop_count++;
+        return;
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    event = &ring->events[head & ring->mask];
+    event->ts = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    event->msg_id = msg_id;
+    event->net_id = net_id;
+    event->ch_id = ch_id;
+    event->val = val;
+    event->type = type;
+    event->action = action;
+    event->reserved = 0;
+    __atomic_store_n( &ring->head, head + 1, __ATOMIC_RELEASE );
+}
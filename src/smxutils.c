@@ -8,11 +8,194 @@
  * Utility functions for the runtime system library of Streamix
  */
 
+#define _GNU_SOURCE
+
 #include <errno.h>
 #include <string.h>
 #include "smxlog.h"
 #include "smxutils.h"
 
+/*****************************************************************************/
+uint64_t smx_get_elapsed_ns( struct timespec* start, struct timespec* end )
+{
+    int64_t elapsed = ( end->tv_sec - start->tv_sec ) * 1000000000LL
+        + ( end->tv_nsec - start->tv_nsec );
+    return ( elapsed < 0 ) ? 0 : elapsed;
+}
+
+/*****************************************************************************/
+uint64_t smx_get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************/
+uint64_t smx_hash_bytes( uint64_t hash, const void* data, size_t len )
+{
+    const unsigned char* bytes = data;
+    while( len-- > 0 )
+    {
+        hash ^= *bytes++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/*****************************************************************************/
+uint64_t smx_hash_str( const char* str )
+{
+    uint64_t hash = SMX_HASH_INIT;
+    while( *str != '\0' )
+    {
+        hash ^= ( unsigned char )*str++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/*****************************************************************************/
+uint64_t smx_hash_u64( uint64_t val )
+{
+    val = ( val ^ ( val >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    val = ( val ^ ( val >> 27 ) ) * 0x94d049bb133111ebULL;
+    return val ^ ( val >> 31 );
+}
+
+/*****************************************************************************/
+smx_hmap_t* smx_hmap_create( size_t size )
+{
+    size_t len = 16;
+    smx_hmap_t* map = smx_malloc( sizeof( struct smx_hmap_s ) );
+    if( map == NULL )
+        return NULL;
+
+    // keep the load factor below one half
+    while( len < 2 * size )
+        len <<= 1;
+    map->items = calloc( len, sizeof( struct smx_hmap_item_s ) );
+    if( map->items == NULL )
+    {
+        free( map );
+        return NULL;
+    }
+    map->size = len;
+    map->count = 0;
+    return map;
+}
+
+/*****************************************************************************/
+void smx_hmap_destroy( smx_hmap_t* map, void ( *destroy )( void* ) )
+{
+    size_t i;
+
+    if( map == NULL )
+        return;
+
+    for( i = 0; i < map->size; i++ )
+    {
+        if( map->items[i].key == NULL )
+            continue;
+        free( map->items[i].key );
+        if( destroy != NULL )
+            destroy( map->items[i].val );
+    }
+    free( map->items );
+    free( map );
+}
+
+/*****************************************************************************/
+void* smx_hmap_get( smx_hmap_t* map, const char* key )
+{
+    uint64_t hash = smx_hash_str( key );
+    size_t idx = hash & ( map->size - 1 );
+
+    while( map->items[idx].key != NULL )
+    {
+        if( map->items[idx].hash == hash
+                && strcmp( map->items[idx].key, key ) == 0 )
+            return map->items[idx].val;
+        idx = ( idx + 1 ) & ( map->size - 1 );
+    }
+    return NULL;
+}
+
+/*****************************************************************************/
+int smx_hmap_grow( smx_hmap_t* map, size_t size )
+{
+    size_t i;
+    size_t idx;
+    smx_hmap_item_t* items = calloc( size, sizeof( struct smx_hmap_item_s ) );
+    if( items == NULL )
+        return -1;
+
+    for( i = 0; i < map->size; i++ )
+    {
+        if( map->items[i].key == NULL )
+            continue;
+        idx = map->items[i].hash & ( size - 1 );
+        while( items[idx].key != NULL )
+            idx = ( idx + 1 ) & ( size - 1 );
+        items[idx] = map->items[i];
+    }
+    free( map->items );
+    map->items = items;
+    map->size = size;
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_hmap_set( smx_hmap_t* map, const char* key, void* val )
+{
+    uint64_t hash;
+    size_t idx;
+
+    if( 2 * ( map->count + 1 ) > map->size
+            && smx_hmap_grow( map, 2 * map->size ) < 0 )
+        return -1;
+
+    hash = smx_hash_str( key );
+    idx = hash & ( map->size - 1 );
+    while( map->items[idx].key != NULL )
+    {
+        if( map->items[idx].hash == hash
+                && strcmp( map->items[idx].key, key ) == 0 )
+        {
+            map->items[idx].val = val;
+            return 0;
+        }
+        idx = ( idx + 1 ) & ( map->size - 1 );
+    }
+    map->items[idx].key = strdup( key );
+    if( map->items[idx].key == NULL )
+        return -1;
+    map->items[idx].hash = hash;
+    map->items[idx].val = val;
+    map->count++;
+    return 0;
+}
+
+/*****************************************************************************/
+int smx_mutex_init( pthread_mutex_t* mutex, bool is_prio_inherit )
+{
+    int rc;
+    pthread_mutexattr_t mutexattr;
+
+    pthread_mutexattr_init( &mutexattr );
+    if( is_prio_inherit )
+    {
+        pthread_mutexattr_setprotocol( &mutexattr, PTHREAD_PRIO_INHERIT );
+    }
+    else
+    {
+        pthread_mutexattr_settype( &mutexattr, PTHREAD_MUTEX_ADAPTIVE_NP );
+    }
+    rc = pthread_mutex_init( mutex, &mutexattr );
+    pthread_mutexattr_destroy( &mutexattr );
+    return rc;
+}
+
 /*****************************************************************************/
 void* smx_malloc( size_t size )
 {
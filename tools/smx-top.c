@@ -0,0 +1,239 @@
+/**
+ * @author  Simon Maurer
+ * @license
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ *  You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * A top-like viewer of the live metrics of a running Streamix application
+ * (see smxmetrics.h).
+ *
+ * Usage: smx-top [-d <interval_ms>] <pid|shm_name>
+ *
+ * The tool only uses the layout definitions of smxmetrics.h and does not link
+ * against the RTS library.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "smxmetrics.h"
+
+/** The default refresh interval in milliseconds */
+#define SMX_TOP_INTERVAL_MS 1000
+
+/*****************************************************************************/
+const char* smx_top_err_str( int err )
+{
+    switch( err )
+    {
+        case 0: return "-";
+        case SMX_CHANNEL_ERR_NO_DEFAULT: return "no_default";
+        case SMX_CHANNEL_ERR_NO_TARGET: return "no_target";
+        case SMX_CHANNEL_ERR_DL_MISS: return "dl_miss";
+        case SMX_CHANNEL_ERR_NO_DATA: return "no_data";
+        case SMX_CHANNEL_ERR_NO_SPACE: return "no_space";
+        case SMX_CHANNEL_ERR_FILTER: return "filter";
+        case SMX_CHANNEL_ERR_UNINITIALISED: return "uninit";
+        case SMX_CHANNEL_ERR_TIMEOUT: return "timeout";
+        case SMX_CHANNEL_ERR_CV: return "cv";
+        default: return "?";
+    }
+}
+
+/*****************************************************************************/
+const char* smx_top_state_str( int state )
+{
+    switch( state )
+    {
+        case SMX_METRICS_NET_INIT: return "init";
+        case SMX_METRICS_NET_RUN: return "run";
+        case SMX_METRICS_NET_BLOCKED_READ: return "blk_rd";
+        case SMX_METRICS_NET_BLOCKED_WRITE: return "blk_wr";
+        case SMX_METRICS_NET_END: return "end";
+        default: return "?";
+    }
+}
+
+/*****************************************************************************/
+void smx_top_print( smx_metrics_header_t* header, smx_metrics_net_t* nets,
+        smx_metrics_ch_t* chs, uint64_t* last_net_counts,
+        uint64_t* last_impl_sums, uint64_t* last_ch_counts, double interval )
+{
+    uint32_t i;
+    uint64_t count;
+    uint64_t impl_sum;
+    uint64_t impl_time;
+    uint64_t uptime;
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    uptime = ( now.tv_sec * 1000000000ULL + now.tv_nsec - header->start_ts )
+        / 1000000000ULL;
+    printf( "\033[H\033[2J" );
+    printf( "smx-top - pid %d, up %lu s, %u nets, %u channels\n\n",
+            header->pid, uptime, header->net_count, header->ch_count );
+
+    printf( "%5s %-24s %-7s %12s %10s %12s\n", "ID", "NET", "STATE", "LOOPS",
+            "RATE[1/s]", "IMPL[us]" );
+    for( i = 0; i < header->net_count; i++ )
+    {
+        if( nets[i].id < 0 )
+            continue;
+        count = __atomic_load_n( &nets[i].count, __ATOMIC_RELAXED );
+        impl_sum = __atomic_load_n( &nets[i].impl_time_sum, __ATOMIC_RELAXED );
+        // the mean over the refresh interval or the last value if idle
+        impl_time = ( count > last_net_counts[i] )
+            ? ( impl_sum - last_impl_sums[i] ) / ( count - last_net_counts[i] )
+            : __atomic_load_n( &nets[i].impl_time, __ATOMIC_RELAXED );
+        printf( "%5d %-24.24s %-7s %12lu %10.1f %12.1f\n", nets[i].id,
+                nets[i].name, smx_top_state_str( __atomic_load_n(
+                        &nets[i].state, __ATOMIC_RELAXED ) ), count,
+                ( count - last_net_counts[i] ) / interval, impl_time / 1000.0 );
+        last_net_counts[i] = count;
+        last_impl_sums[i] = impl_sum;
+    }
+
+    printf( "\n%5s %-24s %11s %9s %10s %8s %8s %11s %11s %-10s %-10s\n", "ID",
+            "CHANNEL", "NETS", "FILL", "MSG[1/s]", "OVERWR", "COPY",
+            "BLK_RD[ms]", "BLK_WR[ms]", "ERR_RD", "ERR_WR" );
+    for( i = 0; i < header->ch_count; i++ )
+    {
+        if( chs[i].id < 0 )
+            continue;
+        count = __atomic_load_n( &chs[i].write_count, __ATOMIC_RELAXED );
+        printf( "%5d %-24.24s %5d->%-4d %4d/%-4d %10.1f %8d %8d %11.1f %11.1f"
+                " %-10s %-10s\n", chs[i].id, chs[i].name, chs[i].writer_net_id,
+                chs[i].reader_net_id,
+                __atomic_load_n( &chs[i].count, __ATOMIC_RELAXED ),
+                chs[i].length, ( count - last_ch_counts[i] ) / interval,
+                __atomic_load_n( &chs[i].overwrite, __ATOMIC_RELAXED ),
+                __atomic_load_n( &chs[i].copy, __ATOMIC_RELAXED ),
+                __atomic_load_n( &chs[i].read_block_time, __ATOMIC_RELAXED )
+                / 1000000.0,
+                __atomic_load_n( &chs[i].write_block_time, __ATOMIC_RELAXED )
+                / 1000000.0,
+                smx_top_err_str( __atomic_load_n( &chs[i].read_err,
+                        __ATOMIC_RELAXED ) ),
+                smx_top_err_str( __atomic_load_n( &chs[i].write_err,
+                        __ATOMIC_RELAXED ) ) );
+        last_ch_counts[i] = count;
+    }
+    fflush( stdout );
+}
+
+/*****************************************************************************/
+int main( int argc, char** argv )
+{
+    int opt;
+    int fd;
+    int interval_ms = SMX_TOP_INTERVAL_MS;
+    char shm_name[100];
+    const char* target;
+    struct stat st;
+    struct timespec ts;
+    uint8_t* map;
+    smx_metrics_header_t* header;
+    smx_metrics_net_t* nets;
+    smx_metrics_ch_t* chs;
+    uint64_t* last_net_counts;
+    uint64_t* last_impl_sums;
+    uint64_t* last_ch_counts;
+
+    while( ( opt = getopt( argc, argv, "d:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+            case 'd':
+                interval_ms = atoi( optarg );
+                break;
+            default:
+                fprintf( stderr, "usage: %s [-d <interval_ms>]"
+                        " <pid|shm_name>\n", argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+    if( optind >= argc || interval_ms <= 0 )
+    {
+        fprintf( stderr, "usage: %s [-d <interval_ms>] <pid|shm_name>\n",
+                argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    target = argv[optind];
+    if( strspn( target, "0123456789" ) == strlen( target ) )
+        snprintf( shm_name, sizeof( shm_name ), "/smx-%s", target );
+    else if( target[0] != '/' )
+        snprintf( shm_name, sizeof( shm_name ), "/%s", target );
+    else
+        snprintf( shm_name, sizeof( shm_name ), "%s", target );
+
+    fd = shm_open( shm_name, O_RDONLY, 0 );
+    if( fd < 0 )
+    {
+        fprintf( stderr, "error: cannot open metrics segment '%s': %s\n",
+                shm_name, strerror( errno ) );
+        return EXIT_FAILURE;
+    }
+    if( fstat( fd, &st ) < 0
+            || ( size_t )st.st_size < sizeof( struct smx_metrics_header_s ) )
+    {
+        fprintf( stderr, "error: metrics segment '%s' is not initialised\n",
+                shm_name );
+        return EXIT_FAILURE;
+    }
+    map = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED )
+    {
+        fprintf( stderr, "error: cannot map metrics segment '%s': %s\n",
+                shm_name, strerror( errno ) );
+        return EXIT_FAILURE;
+    }
+
+    header = ( smx_metrics_header_t* )map;
+    if( memcmp( header->magic, SMX_METRICS_MAGIC, sizeof( header->magic ) ) != 0
+            || header->version != SMX_METRICS_VERSION
+            || header->net_size != sizeof( struct smx_metrics_net_s )
+            || header->ch_size != sizeof( struct smx_metrics_ch_s )
+            || ( size_t )st.st_size != header->header_size
+                + header->net_count * header->net_size
+                + header->ch_count * header->ch_size )
+    {
+        fprintf( stderr, "error: '%s' is not a compatible metrics segment\n",
+                shm_name );
+        return EXIT_FAILURE;
+    }
+    nets = ( smx_metrics_net_t* )( map + header->header_size );
+    chs = ( smx_metrics_ch_t* )( nets + header->net_count );
+
+    last_net_counts = calloc( header->net_count + 1, sizeof( uint64_t ) );
+    last_impl_sums = calloc( header->net_count + 1, sizeof( uint64_t ) );
+    last_ch_counts = calloc( header->ch_count + 1, sizeof( uint64_t ) );
+    if( last_net_counts == NULL || last_impl_sums == NULL
+            || last_ch_counts == NULL )
+        return EXIT_FAILURE;
+
+    ts.tv_sec = interval_ms / 1000;
+    ts.tv_nsec = ( interval_ms % 1000 ) * 1000000;
+    while( kill( header->pid, 0 ) == 0 || errno != ESRCH )
+    {
+        smx_top_print( header, nets, chs, last_net_counts, last_impl_sums,
+                last_ch_counts, interval_ms / 1000.0 );
+        nanosleep( &ts, NULL );
+    }
+    printf( "process %d has terminated\n", header->pid );
+
+    free( last_net_counts );
+    free( last_impl_sums );
+    free( last_ch_counts );
+    munmap( map, st.st_size );
+    return EXIT_SUCCESS;
+}